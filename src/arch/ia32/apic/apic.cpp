@@ -15,7 +15,11 @@
  */
 
 #include "stdio.h"
+#include "string.h"
 #include "assert.h"
+#include "common.h"
+#include "vmm.h"
+#include "boot_info.h"
 #include "intr.h"
 #include "cpu.hpp"
 #include "apic.h"
@@ -35,7 +39,102 @@ APIC::~APIC(void) {
 
 int32_t APIC::init(void) {
     LOCAL_APIC::init();
+    if (parse_madt() == false) {
+        warn("MADT not found.\n");
+    }
     IO_APIC::init();
     info("apic init.\n");
     return 0;
 }
+
+uintptr_t APIC::map_phys(uintptr_t _pa, size_t _len) {
+    VMM &     vmm   = VMM::get_instance();
+    uintptr_t start = _pa & COMMON::PAGE_MASK;
+    uintptr_t end   = COMMON::ALIGN(_pa + _len, COMMON::PAGE_SIZE);
+    for (uintptr_t pa = start; pa < end; pa += COMMON::PAGE_SIZE) {
+        if (vmm.get_mmap(vmm.get_pgd(), VMM_PA2VA(pa), nullptr) == false) {
+            vmm.mmap(vmm.get_pgd(), VMM_PA2VA(pa), pa,
+                     VMM_PAGE_READABLE | VMM_PAGE_WRITABLE | VMM_PAGE_GLOBAL);
+        }
+    }
+    return VMM_PA2VA(_pa);
+}
+
+bool APIC::checksum(const void *_data, size_t _len) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < _len; i++) {
+        sum += ((const uint8_t *)_data)[i];
+    }
+    return sum == 0;
+}
+
+const APIC::acpi_header_t *APIC::find_table(const char *_sig) {
+    resource_t resource = BOOT_INFO::get_acpi();
+    if (resource.mem.addr == 0) {
+        return nullptr;
+    }
+    // RSDP 保存在启动信息中，不需要映射
+    const rsdp_t *rsdp = (const rsdp_t *)resource.mem.addr;
+    if (checksum(rsdp, RSDP_V1_LEN) == false) {
+        return nullptr;
+    }
+    // ACPI 2.0 之后优先使用 64 位地址的 XSDT
+    uintptr_t root  = rsdp->rsdt_addr;
+    size_t    entry = sizeof(uint32_t);
+    if (rsdp->revision >= 2 && rsdp->xsdt_addr != 0) {
+        root  = rsdp->xsdt_addr;
+        entry = sizeof(uint64_t);
+    }
+    // 先映射表头得到长度，再映射整个表
+    const acpi_header_t *sdt =
+        (const acpi_header_t *)map_phys(root, sizeof(acpi_header_t));
+    map_phys(root, sdt->length);
+    if (checksum(sdt, sdt->length) == false) {
+        return nullptr;
+    }
+    size_t count = (sdt->length - sizeof(acpi_header_t)) / entry;
+    for (size_t i = 0; i < count; i++) {
+        // 表项不一定对齐
+        uint64_t       addr = 0;
+        const uint8_t *ptr  = (const uint8_t *)(sdt + 1) + i * entry;
+        memcpy(&addr, ptr, entry);
+        const acpi_header_t *table =
+            (const acpi_header_t *)map_phys(addr, sizeof(acpi_header_t));
+        if (memcmp(table->signature, _sig, sizeof(table->signature)) != 0) {
+            continue;
+        }
+        map_phys(addr, table->length);
+        if (checksum(table, table->length) == true) {
+            return table;
+        }
+    }
+    return nullptr;
+}
+
+bool APIC::parse_madt(void) {
+    const madt_t *madt = (const madt_t *)find_table("APIC");
+    if (madt == nullptr) {
+        return false;
+    }
+    const uint8_t *ptr = madt->entries;
+    const uint8_t *end = (const uint8_t *)madt + madt->header.length;
+    while (ptr + sizeof(madt_entry_t) <= end) {
+        const madt_entry_t *entry = (const madt_entry_t *)ptr;
+        if (entry->length < sizeof(madt_entry_t)) {
+            break;
+        }
+        if (entry->type == MADT_IO_APIC) {
+            const madt_io_apic_t *io_apic = (const madt_io_apic_t *)entry;
+            IO_APIC::add(io_apic->id, io_apic->addr, io_apic->gsi_base);
+        }
+        else if (entry->type == MADT_ISO) {
+            const madt_iso_t *iso = (const madt_iso_t *)entry;
+            // 只处理 ISA 总线
+            if (iso->bus == 0) {
+                IO_APIC::set_override(iso->source, iso->gsi, iso->flags);
+            }
+        }
+        ptr += entry->length;
+    }
+    return true;
+}
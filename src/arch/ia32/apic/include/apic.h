@@ -18,21 +18,133 @@
 #define _APIC_H_
 
 #include "stdint.h"
+#include "stddef.h"
 
 /**
  * @brief APIC 抽象
+ * 从 ACPI 的 MADT 获取 IO APIC 的地址与 ISA 中断的重定向信息
  */
 class APIC {
 private:
+    /**
+     * @brief ACPI RSDP
+     * @see ACPI Specification 5.2.5.3
+     */
+    struct rsdp_t {
+        char     signature[8];
+        uint8_t  checksum;
+        char     oem_id[6];
+        uint8_t  revision;
+        uint32_t rsdt_addr;
+        // 以下 ACPI 2.0 开始支持
+        uint32_t length;
+        uint64_t xsdt_addr;
+        uint8_t  ext_checksum;
+        uint8_t  reserved[3];
+    } __attribute__((packed));
+
+    /// ACPI 1.0 的 RSDP 长度，校验和只覆盖这一部分
+    static constexpr const size_t RSDP_V1_LEN = 20;
+
+    /**
+     * @brief ACPI 表头
+     * @see ACPI Specification 5.2.6
+     */
+    struct acpi_header_t {
+        char     signature[4];
+        uint32_t length;
+        uint8_t  revision;
+        uint8_t  checksum;
+        char     oem_id[6];
+        char     oem_table_id[8];
+        uint32_t oem_revision;
+        uint32_t creator_id;
+        uint32_t creator_revision;
+    } __attribute__((packed));
+
+    /**
+     * @brief MADT 表
+     * @see ACPI Specification 5.2.12
+     */
+    struct madt_t {
+        acpi_header_t header;
+        // 本地 APIC 的物理地址，x2APIC 模式下不使用
+        uint32_t lapic_addr;
+        uint32_t flags;
+        uint8_t  entries[0];
+    } __attribute__((packed));
+
+    /// MADT 项头
+    struct madt_entry_t {
+        uint8_t type;
+        uint8_t length;
+    } __attribute__((packed));
+
+    /// MADT IO APIC 项
+    struct madt_io_apic_t {
+        madt_entry_t entry;
+        uint8_t      id;
+        uint8_t      reserved;
+        uint32_t     addr;
+        uint32_t     gsi_base;
+    } __attribute__((packed));
+
+    /// MADT 中断源重定向项，ISA 中断与全局中断号不同时给出
+    struct madt_iso_t {
+        madt_entry_t entry;
+        uint8_t      bus;
+        uint8_t      source;
+        uint32_t     gsi;
+        uint16_t     flags;
+    } __attribute__((packed));
+
+    /// MADT 项类型
+    static constexpr const uint8_t MADT_IO_APIC = 1;
+    static constexpr const uint8_t MADT_ISO     = 2;
+
+    /**
+     * @brief 检查 ACPI 结构的校验和
+     * @param  _data           数据
+     * @param  _len            长度
+     * @return true            所有字节之和为 0
+     * @return false           校验失败
+     */
+    static bool checksum(const void *_data, size_t _len);
+
+    /**
+     * @brief 在 RSDT/XSDT 中查找表
+     * @param  _sig            表的签名
+     * @return const acpi_header_t*  找到的表，已映射，没有找到返回 nullptr
+     */
+    static const acpi_header_t *find_table(const char *_sig);
+
+    /**
+     * @brief 解析 MADT，将 IO APIC 与 ISA 中断的重定向信息交给 IO_APIC
+     * @return true            成功
+     * @return false           没有 ACPI 或 MADT
+     */
+    static bool parse_madt(void);
+
 protected:
 public:
     APIC(void);
     ~APIC(void);
     static int32_t init(void);
+
+    /**
+     * @brief 将物理地址映射到直接映射区
+     * @param  _pa             物理地址
+     * @param  _len            长度
+     * @return uintptr_t       虚拟地址
+     * @note 直接映射区只包含可用的物理内存，ACPI 表与设备寄存器需要另外映射
+     * 映射在内核高半部分，所有地址空间都可以访问
+     */
+    static uintptr_t map_phys(uintptr_t _pa, size_t _len);
 };
 
 /**
  * @brief 本地 APIC
+ * 每个核心有自己的本地 APIC 与定时器，通过 x2APIC 的 MSR 访问，不需要端口
  */
 class LOCAL_APIC {
 private:
@@ -41,18 +153,184 @@ public:
     LOCAL_APIC(void);
     ~LOCAL_APIC(void);
     static int32_t init(void);
+
+    /**
+     * @brief 通知本地 APIC 中断处理结束
+     */
+    static void eoi(void);
+
+    /**
+     * @brief 设置定时器
+     * @param  _vector         中断号
+     * @param  _mode           IA32_X2APIC_LVT_TIMER_ONESHOT/PERIODIC/TSC_DEADLINE
+     * @param  _count          计数器初值，TSC-deadline 模式下为到期的 TSC
+     * @note 计数器不分频，超过 32 位时取最大值，_count 为 0 时停止计数
+     */
+    static void set_timer(uint8_t _vector, uint32_t _mode, uint64_t _count);
+
+    /**
+     * @brief 停止并屏蔽定时器
+     */
+    static void stop_timer(void);
+
+    /**
+     * @brief 获取本地 APIC ID
+     * @return uint32_t        x2APIC ID
+     */
+    static uint32_t get_id(void);
+
+    /**
+     * @brief 读取计数器的当前值
+     * @return uint32_t        当前值，TSC-deadline 模式下为 0
+     */
+    static uint32_t get_timer_count(void);
 };
 
 /**
  * @brief IO APIC
+ * 将 ISA 中断 0~15 路由到 INTR::IRQ0 开始的中断号，替代 8259A
+ * 每个中断可以单独屏蔽，设置触发方式与发送到的核心
  */
 class IO_APIC {
 private:
+    /// 一个 IO APIC
+    struct io_apic_t {
+        /// 寄存器的虚拟地址
+        uintptr_t base;
+        /// 第一个全局中断号
+        uint32_t gsi_base;
+        /// 重定向表项数
+        uint32_t count;
+        /// IO APIC ID
+        uint8_t id;
+    };
+
+    /// 支持的 IO APIC 数量
+    static constexpr const size_t IO_APIC_MAX = 8;
+    /// ISA 中断数量
+    static constexpr const size_t ISA_IRQ_MAX = 16;
+    /// 没有对应全局中断号的 ISA 中断
+    static constexpr const uint32_t GSI_NONE = UINT32_MAX;
+    /// 寄存器选择，写入要访问的寄存器
+    static constexpr const uint32_t IOREGSEL = 0x00;
+    /// 寄存器窗口，读写选择的寄存器
+    static constexpr const uint32_t IOWIN = 0x10;
+    /// 版本寄存器，bit16~23 为最大的重定向表项号
+    static constexpr const uint8_t REG_VER = 0x01;
+    /// 重定向表，每项占两个寄存器
+    static constexpr const uint8_t REG_REDTBL = 0x10;
+    /// 重定向表项低 32 位，bit0~7 为中断号，其余位与 LVT 相同
+    static constexpr const uint32_t RTE_POLAR_LOW = 1 << 13;
+    static constexpr const uint32_t RTE_LEVEL     = 1 << 15;
+    static constexpr const uint32_t RTE_MASK      = 1 << 16;
+    /// 重定向表项高 32 位，bit24~31 为目标 APIC ID
+    static constexpr const uint32_t RTE_DEST_SHIFT = 24;
+
+    /// MADT 给出的 IO APIC
+    static io_apic_t io_apics[IO_APIC_MAX];
+    /// IO APIC 数量
+    static size_t io_apic_count;
+    /// ISA 中断对应的全局中断号，被其它 ISA 中断占用时为 GSI_NONE
+    static uint32_t isa_gsi[ISA_IRQ_MAX];
+    /// ISA 中断的极性与触发方式，RTE_POLAR_LOW 与 RTE_LEVEL
+    static uint32_t isa_flags[ISA_IRQ_MAX];
+
+    /**
+     * @brief 查找全局中断号所在的 IO APIC
+     * @param  _gsi            全局中断号
+     * @return io_apic_t*      IO APIC，没有时返回 nullptr
+     */
+    static io_apic_t *find(uint32_t _gsi);
+
+    /**
+     * @brief 读寄存器
+     * @param  _io_apic        IO APIC
+     * @param  _reg            寄存器号
+     * @return uint32_t        读到的值
+     */
+    static uint32_t read(const io_apic_t &_io_apic, uint8_t _reg);
+
+    /**
+     * @brief 写寄存器
+     * @param  _io_apic        IO APIC
+     * @param  _reg            寄存器号
+     * @param  _val            要写的值
+     */
+    static void write(const io_apic_t &_io_apic, uint8_t _reg, uint32_t _val);
+
+    /**
+     * @brief 读 ISA 中断的重定向表项低 32 位
+     * @param  _irq            ISA 中断号
+     * @return uint32_t        表项，没有对应的表项时为 RTE_MASK
+     */
+    static uint32_t get_rte(uint8_t _irq);
+
+    /**
+     * @brief 写 ISA 中断的重定向表项
+     * @param  _irq            ISA 中断号
+     * @param  _low            低 32 位
+     * @param  _dest           目标 APIC ID，为 UINT32_MAX 时不修改
+     */
+    static void set_rte(uint8_t _irq, uint32_t _low, uint32_t _dest);
+
 protected:
 public:
     IO_APIC(void);
     ~IO_APIC(void);
+
+    /**
+     * @brief 初始化，屏蔽所有表项，ISA 中断设置好中断号与触发方式
+     * @return int32_t         成功返回 0，没有 IO APIC 返回 -1
+     * @note 需要在 parse_madt 之后调用
+     */
     static int32_t init(void);
+
+    /**
+     * @brief 添加 MADT 中的 IO APIC
+     * @param  _id             IO APIC ID
+     * @param  _pa             寄存器的物理地址
+     * @param  _gsi_base       第一个全局中断号
+     */
+    static void add(uint8_t _id, uintptr_t _pa, uint32_t _gsi_base);
+
+    /**
+     * @brief 记录 MADT 中 ISA 中断的重定向信息
+     * @param  _irq            ISA 中断号
+     * @param  _gsi            全局中断号
+     * @param  _flags          MADT 中的 MPS INTI 标志
+     * @note 原来使用 _gsi 的 ISA 中断不再有对应的表项
+     */
+    static void set_override(uint8_t _irq, uint32_t _gsi, uint16_t _flags);
+
+    /**
+     * @brief 是否使用 IO APIC
+     * @return true            中断由 IO APIC 发送，8259A 已关闭
+     * @return false           没有 IO APIC
+     */
+    static bool available(void);
+
+    /**
+     * @brief 屏蔽或打开 ISA 中断
+     * @param  _irq            ISA 中断号
+     * @param  _mask           是否屏蔽
+     */
+    static void set_mask(uint8_t _irq, bool _mask);
+
+    /**
+     * @brief 设置 ISA 中断的触发方式
+     * @param  _irq            ISA 中断号
+     * @param  _level          是否为电平触发
+     * @param  _low            是否为低电平有效
+     */
+    static void set_trigger(uint8_t _irq, bool _level, bool _low);
+
+    /**
+     * @brief 设置 ISA 中断发送到的核心
+     * @param  _irq            ISA 中断号
+     * @param  _apic_id        目标核心的本地 APIC ID
+     * @note 使用物理目标模式，ID 需要小于 256
+     */
+    static void set_dest(uint8_t _irq, uint32_t _apic_id);
 };
 
 static APIC apic;
@@ -14,12 +14,19 @@
  * </table>
  */
 
+#include "stdio.h"
 #include "intr.h"
 #include "cpu.hpp"
 #include "io.h"
 #include "apic.h"
 
-/// @todo
+IO_APIC::io_apic_t IO_APIC::io_apics[IO_APIC_MAX];
+size_t             IO_APIC::io_apic_count = 0;
+// 没有重定向时 ISA 中断号即为全局中断号，高电平边沿触发
+// IRQ2 连接从 8259A，不会产生中断
+uint32_t IO_APIC::isa_gsi[ISA_IRQ_MAX] = {0, 1, GSI_NONE, 3,  4,  5,  6,  7,
+                                          8, 9, 10,       11, 12, 13, 14, 15};
+uint32_t IO_APIC::isa_flags[ISA_IRQ_MAX];
 
 IO_APIC::IO_APIC(void) {
     return;
@@ -29,7 +36,147 @@ IO_APIC::~IO_APIC(void) {
     return;
 }
 
+IO_APIC::io_apic_t *IO_APIC::find(uint32_t _gsi) {
+    for (size_t i = 0; i < io_apic_count; i++) {
+        if (_gsi >= io_apics[i].gsi_base &&
+            _gsi < io_apics[i].gsi_base + io_apics[i].count) {
+            return &io_apics[i];
+        }
+    }
+    return nullptr;
+}
+
+uint32_t IO_APIC::read(const io_apic_t &_io_apic, uint8_t _reg) {
+    IO::get_instance().write32((void *)(_io_apic.base + IOREGSEL), _reg);
+    return IO::get_instance().read32((void *)(_io_apic.base + IOWIN));
+}
+
+void IO_APIC::write(const io_apic_t &_io_apic, uint8_t _reg, uint32_t _val) {
+    IO::get_instance().write32((void *)(_io_apic.base + IOREGSEL), _reg);
+    IO::get_instance().write32((void *)(_io_apic.base + IOWIN), _val);
+    return;
+}
+
+uint32_t IO_APIC::get_rte(uint8_t _irq) {
+    uint32_t   gsi     = isa_gsi[_irq];
+    io_apic_t *io_apic = find(gsi);
+    if (io_apic == nullptr) {
+        return RTE_MASK;
+    }
+    return read(*io_apic, REG_REDTBL + (gsi - io_apic->gsi_base) * 2);
+}
+
+void IO_APIC::set_rte(uint8_t _irq, uint32_t _low, uint32_t _dest) {
+    uint32_t   gsi     = isa_gsi[_irq];
+    io_apic_t *io_apic = find(gsi);
+    if (io_apic == nullptr) {
+        return;
+    }
+    uint8_t reg = REG_REDTBL + (gsi - io_apic->gsi_base) * 2;
+    // 先屏蔽再修改目标，避免中断发送到中间状态
+    write(*io_apic, reg, read(*io_apic, reg) | RTE_MASK);
+    if (_dest != UINT32_MAX) {
+        write(*io_apic, reg + 1, _dest << RTE_DEST_SHIFT);
+    }
+    write(*io_apic, reg, _low);
+    return;
+}
+
+void IO_APIC::add(uint8_t _id, uintptr_t _pa, uint32_t _gsi_base) {
+    if (io_apic_count == IO_APIC_MAX) {
+        warn("Too many IO APIC, 0x%X ignored.\n", _id);
+        return;
+    }
+    io_apic_t &io_apic = io_apics[io_apic_count++];
+    io_apic.id         = _id;
+    io_apic.base       = APIC::map_phys(_pa, IOWIN + sizeof(uint32_t));
+    io_apic.gsi_base   = _gsi_base;
+    io_apic.count      = ((read(io_apic, REG_VER) >> 16) & 0xFF) + 1;
+    return;
+}
+
+void IO_APIC::set_override(uint8_t _irq, uint32_t _gsi, uint16_t _flags) {
+    if (_irq >= ISA_IRQ_MAX) {
+        return;
+    }
+    // 一个全局中断号只能对应一个 ISA 中断，如 IRQ0 通常重定向到 GSI2
+    for (uint8_t irq = 0; irq < ISA_IRQ_MAX; irq++) {
+        if (irq != _irq && isa_gsi[irq] == _gsi) {
+            isa_gsi[irq] = GSI_NONE;
+        }
+    }
+    isa_gsi[_irq]   = _gsi;
+    isa_flags[_irq] = 0;
+    // bit0~1 极性，11b 为低电平有效；bit2~3 触发方式，11b 为电平触发
+    // 00b 表示与总线相同，ISA 为高电平边沿触发
+    if ((_flags & 0x3) == 0x3) {
+        isa_flags[_irq] |= RTE_POLAR_LOW;
+    }
+    if (((_flags >> 2) & 0x3) == 0x3) {
+        isa_flags[_irq] |= RTE_LEVEL;
+    }
+    return;
+}
+
 int32_t IO_APIC::init(void) {
+    if (io_apic_count == 0) {
+        warn("No IO APIC, using 8259A.\n");
+        return -1;
+    }
+    // 屏蔽所有表项
+    for (size_t i = 0; i < io_apic_count; i++) {
+        for (uint32_t j = 0; j < io_apics[i].count; j++) {
+            write(io_apics[i], REG_REDTBL + j * 2, RTE_MASK);
+        }
+    }
+    // ISA 中断使用与 8259A 相同的中断号，默认发送到当前核心
+    uint32_t dest = LOCAL_APIC::get_id();
+    // 级联中断与被占用的中断没有表项
+    for (uint8_t irq = 0; irq < ISA_IRQ_MAX; irq++) {
+        if (isa_gsi[irq] == GSI_NONE) {
+            continue;
+        }
+        set_rte(irq, (INTR::IRQ0 + irq) | isa_flags[irq] | RTE_MASK, dest);
+    }
     info("io apic init.\n");
     return 0;
-}
\ No newline at end of file
+}
+
+bool IO_APIC::available(void) {
+    return io_apic_count != 0;
+}
+
+void IO_APIC::set_mask(uint8_t _irq, bool _mask) {
+    if (_irq >= ISA_IRQ_MAX) {
+        return;
+    }
+    uint32_t low = get_rte(_irq) & ~RTE_MASK;
+    if (_mask == true) {
+        low |= RTE_MASK;
+    }
+    set_rte(_irq, low, UINT32_MAX);
+    return;
+}
+
+void IO_APIC::set_trigger(uint8_t _irq, bool _level, bool _low) {
+    if (_irq >= ISA_IRQ_MAX) {
+        return;
+    }
+    uint32_t low = get_rte(_irq) & ~(RTE_LEVEL | RTE_POLAR_LOW);
+    if (_level == true) {
+        low |= RTE_LEVEL;
+    }
+    if (_low == true) {
+        low |= RTE_POLAR_LOW;
+    }
+    set_rte(_irq, low, UINT32_MAX);
+    return;
+}
+
+void IO_APIC::set_dest(uint8_t _irq, uint32_t _apic_id) {
+    if (_irq >= ISA_IRQ_MAX) {
+        return;
+    }
+    set_rte(_irq, get_rte(_irq), _apic_id);
+    return;
+}
@@ -48,10 +48,9 @@ int32_t LOCAL_APIC::init(void) {
             CPU::IA32_APIC_BASE_X2APIC_ENABLE_BIT);
     CPU::WRITE_MSR(CPU::IA32_APIC_BASE, msr);
     // 设置 SIVR
+    // 不禁止 EOI 广播，IO APIC 依靠广播的 EOI 清除电平触发中断的 Remote IRR
     msr = CPU::READ_MSR(CPU::IA32_X2APIC_SIVR);
-    if (cpuid.eoi() == true) {
-        msr |= CPU::IA32_X2APIC_SIVR_EOI_ENABLE_BIT;
-    }
+    msr &= ~CPU::IA32_X2APIC_SIVR_EOI_ENABLE_BIT;
     msr |= CPU::IA32_X2APIC_SIVR_APIC_ENABLE_BIT;
     CPU::WRITE_MSR(CPU::IA32_X2APIC_SIVR, msr);
 
@@ -59,7 +58,13 @@ int32_t LOCAL_APIC::init(void) {
     msr = 0;
     msr |= CPU::IA32_X2APIC_LVT_MASK_BIT;
     msr = 0x10000;
-    CPU::WRITE_MSR(CPU::IA32_X2APIC_CMCI, msr);
+    // 没有 CMCI 时写入会产生 #GP
+    uint32_t max_lvt = (CPU::READ_MSR(CPU::IA32_X2APIC_VERSION) >>
+                        CPU::IA32_X2APIC_VERSION_MAX_LVT_SHIFT) &
+                       0xFF;
+    if (max_lvt >= CPU::IA32_X2APIC_VERSION_MAX_LVT_CMCI) {
+        CPU::WRITE_MSR(CPU::IA32_X2APIC_CMCI, msr);
+    }
     CPU::WRITE_MSR(CPU::IA32_X2APIC_LVT_TIMER, msr);
     CPU::WRITE_MSR(CPU::IA32_X2APIC_LVT_THERMAL, msr);
     CPU::WRITE_MSR(CPU::IA32_X2APIC_LVT_PMI, msr);
@@ -70,3 +75,46 @@ int32_t LOCAL_APIC::init(void) {
     info("local apic init.\n");
     return 0;
 }
+
+void LOCAL_APIC::eoi(void) {
+    CPU::WRITE_MSR(CPU::IA32_X2APIC_EOI, 0);
+    return;
+}
+
+void LOCAL_APIC::set_timer(uint8_t _vector, uint32_t _mode, uint64_t _count) {
+    CPU::WRITE_MSR(CPU::IA32_X2APIC_LVT_TIMER, _vector | _mode);
+    if (_mode == CPU::IA32_X2APIC_LVT_TIMER_TSC_DEADLINE) {
+        // 模式切换完成后才能写入到期时间，否则可能被忽略
+        CPU::MFENCE();
+        CPU::WRITE_MSR(CPU::IA32_TSC_DEADLINE, _count);
+    }
+    else {
+        CPU::WRITE_MSR(CPU::IA32_X2APIC_DIV_CONF, CPU::IA32_X2APIC_DIV_CONF_1);
+        // 计数器只有 32 位
+        CPU::WRITE_MSR(CPU::IA32_X2APIC_TIMER_INIT_COUNT,
+                       _count > UINT32_MAX ? UINT32_MAX : _count);
+    }
+    return;
+}
+
+void LOCAL_APIC::stop_timer(void) {
+    uint64_t lvt = CPU::READ_MSR(CPU::IA32_X2APIC_LVT_TIMER);
+    CPU::WRITE_MSR(CPU::IA32_X2APIC_LVT_TIMER,
+                   lvt | CPU::IA32_X2APIC_LVT_MASK_BIT);
+    // 两种模式下写 0 都会停止计数
+    if ((lvt & CPU::IA32_X2APIC_LVT_TIMER_TSC_DEADLINE) != 0) {
+        CPU::WRITE_MSR(CPU::IA32_TSC_DEADLINE, 0);
+    }
+    else {
+        CPU::WRITE_MSR(CPU::IA32_X2APIC_TIMER_INIT_COUNT, 0);
+    }
+    return;
+}
+
+uint32_t LOCAL_APIC::get_id(void) {
+    return CPU::READ_MSR(CPU::IA32_X2APIC_APICID);
+}
+
+uint32_t LOCAL_APIC::get_timer_count(void) {
+    return CPU::READ_MSR(CPU::IA32_X2APIC_TIMER_CUR_COUNT);
+}
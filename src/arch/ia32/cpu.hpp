@@ -63,7 +63,7 @@ namespace CPU {
     /// Proctect）标志。
     // 当设置该标志时，处理器会禁止超级用户程序（例如特权级0的程序）向用户级只读页面执行写操作；当该位复位时则反之。该标志有利于UNIX类操作系统在创建进程时实现写时复制（Copy
     // on Write）技术。
-    static constexpr const uint32_t CR0_WP = 0x00010020;
+    static constexpr const uint32_t CR0_WP = 0x00010000;
     static constexpr const uint32_t CR0_AM = 0x00040020;
     static constexpr const uint32_t CR0_NW = 0x20000000;
     static constexpr const uint32_t CR0_CD = 0x40000000;
@@ -83,6 +83,12 @@ namespace CPU {
 
     static constexpr const uint32_t CR3_PWT = 0x00000008;
     static constexpr const uint32_t CR3_PCD = 0x00000010;
+    // CR4.PCIDE 为 1 时，CR3 的低 12 位为当前 PCID
+    static constexpr const uint32_t CR3_PCID_MASK = 0x00000FFF;
+#if defined(__x86_64__)
+    // 写入 CR3 时置位，则不刷新新 PCID 的 TLB 项与页表缓存
+    static constexpr const uint64_t CR3_NOFLUSH = (uint64_t)1 << 63;
+#endif
 
     static constexpr const uint32_t CR4_VME = 0x00000001;
     static constexpr const uint32_t CR4_PVI = 0x00000002;
@@ -118,6 +124,10 @@ namespace CPU {
     // Support for EOI-broadcast suppression
     static constexpr const uint32_t IA32_X2APIC_VERSION_EOI_SUPPORT_BIT = 1
                                                                           << 24;
+    // Max LVT Entry，LVT 项数减一
+    static constexpr const uint32_t IA32_X2APIC_VERSION_MAX_LVT_SHIFT = 16;
+    // Max LVT Entry 不小于此值时才有 CMCI
+    static constexpr const uint32_t IA32_X2APIC_VERSION_MAX_LVT_CMCI = 6;
     // x2APIC Task Priority Register (R/W)
     static constexpr const uint32_t IA32_X2APIC_TPR = 0x808;
     // x2APIC Processor Priority Register (R/O)
@@ -198,7 +208,12 @@ namespace CPU {
     static constexpr const uint32_t IA32_X2APIC_LVT_TRIGGER_BIT = 1 << 15;
     // Bit 16	Set to mask
     static constexpr const uint32_t IA32_X2APIC_LVT_MASK_BIT = 1 << 16;
-    // Bits 17-31	Reserved
+    // Bits 17-18 (timer only)	00b one-shot, 01b periodic, 10b TSC-deadline
+    static constexpr const uint32_t IA32_X2APIC_LVT_TIMER_ONESHOT = 0;
+    static constexpr const uint32_t IA32_X2APIC_LVT_TIMER_PERIODIC = 1 << 17;
+    static constexpr const uint32_t IA32_X2APIC_LVT_TIMER_TSC_DEADLINE = 2
+                                                                         << 17;
+    // Bits 19-31	Reserved
 
     // x2APIC Initial Count Register(R/W)
     static constexpr const uint32_t IA32_X2APIC_TIMER_INIT_COUNT = 0x838;
@@ -206,8 +221,15 @@ namespace CPU {
     static constexpr const uint32_t IA32_X2APIC_TIMER_CUR_COUNT = 0x839;
     // x2APIC Divide Configuration Register (R/W)
     static constexpr const uint32_t IA32_X2APIC_DIV_CONF = 0x83E;
+    // Bits 0,1,3	1011b divide by 1
+    static constexpr const uint32_t IA32_X2APIC_DIV_CONF_1 = 0xB;
     // x2APIC Self IPI Register (W/O)
     static constexpr const uint32_t IA32_X2APIC_SELF_IPI = 0x83F;
+    // TSC Target of Local APIC's TSC Deadline Mode (R/W)
+    static constexpr const uint32_t IA32_TSC_DEADLINE = 0x6E0;
+
+    /// EFLAGS 中断允许位
+    static constexpr const uintptr_t EFLAGS_IF = 0x200;
 
     // 段描述符 DPL
     /// 内核级
@@ -241,6 +263,29 @@ namespace CPU {
         return;
     }
 
+    /**
+     * @brief 读取中断状态
+     * @return true             允许
+     * @return false            禁止
+     */
+    static inline bool STATUS_INTR(void) {
+        uintptr_t eflags;
+        __asm__ volatile("pushf\n\t"
+                         "pop %0\n\t"
+                         : "=r"(eflags));
+        return (eflags & EFLAGS_IF) != 0;
+    }
+
+    /**
+     * @brief 允许中断并等待下一个中断
+     * @note 需要在禁止中断时调用，sti 的下一条指令执行前不响应中断，
+     * 在 hlt 之前到达的中断不会丢失
+     */
+    static inline void WAIT_INTR(void) {
+        __asm__ volatile("sti\n\thlt" ::: "memory");
+        return;
+    }
+
     /**
      * @brief 触发 debug 中断
      */
@@ -273,11 +318,11 @@ namespace CPU {
 
     /**
      * @brief 读取 CR2
-     * @return uint32_t        CR2 值
+     * @return uintptr_t       CR2 值
      */
-    static inline uint32_t READ_CR2(void) {
-        uint32_t cr2;
-        __asm__ volatile("mov %%cr2, %0" : "=b"(cr2));
+    static inline uintptr_t READ_CR2(void) {
+        uintptr_t cr2;
+        __asm__ volatile("mov %%cr2, %0" : "=r"(cr2));
         return cr2;
     }
 
@@ -306,11 +351,21 @@ namespace CPU {
      * @return uint32_t        CR4 值
      */
     static inline uint32_t READ_CR4(void) {
-        uint32_t cr4;
-        __asm__ volatile("mov %%cr4, %0" : "=b"(cr4));
+        uintptr_t cr4;
+        __asm__ volatile("mov %%cr4, %0" : "=r"(cr4));
         return cr4;
     }
 
+    /**
+     * @brief 写入 CR4
+     * @param  _cr4            要写入的值
+     */
+    static inline void WRITE_CR4(uint32_t _cr4) {
+        uintptr_t cr4 = _cr4;
+        __asm__ volatile("mov %0, %%cr4" : : "r"(cr4) : "memory");
+        return;
+    }
+
     /**
      * @brief 刷新页表缓存
      * @param  _addr            要刷新的地址
@@ -320,12 +375,38 @@ namespace CPU {
         return;
     }
 
+    /**
+     * @brief 刷新所有页表缓存
+     * @note 重新写入 CR3，不会刷新全局页
+     */
+    static inline void VMM_FLUSH_ALL(void) {
+        uintptr_t cr3;
+        __asm__ volatile("mov %%cr3, %0" : "=r"(cr3));
+        __asm__ volatile("mov %0, %%cr3" : : "r"(cr3) : "memory");
+        return;
+    }
+
+    /**
+     * @brief 刷新所有地址空间的页表缓存，包括全局页
+     * @note 改变 CR4.PGE 会刷新所有 PCID 的 TLB 项与页表缓存
+     */
+    static inline void VMM_FLUSH_ALL_ASID(void) {
+        uint32_t cr4 = READ_CR4();
+        WRITE_CR4(cr4 ^ CR4_PGE);
+        WRITE_CR4(cr4);
+        return;
+    }
+
     // 开启 PG
     static inline bool ENABLE_PG(void) {
         uintptr_t cr0 = 0;
         __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
         // 最高位 PG 位置 1，分页开启
         cr0 |= (1u << 31);
+        // 开启写保护，内核写入只读页时同样产生缺页，用于写时复制
+        cr0 |= CR0_WP;
+        // 开启全局页，内核的 TLB 项在切换页目录时保留
+        WRITE_CR4(READ_CR4() | CR4_PGE);
         __asm__ volatile("mov %0, %%cr0" : : "r"(cr0));
         info("paging enabled.\n");
         return true;
@@ -365,6 +446,29 @@ namespace CPU {
         return true;
     }
 
+    /**
+     * @brief 设置页目录与地址空间标识(PCID)
+     * @param  _pgd            要设置的页目录
+     * @param  _asid           PCID，未开启 PCID 时必须为 0
+     * @param  _flush          是否刷新 _asid 的缓存
+     * @note 未开启 PCID 时写入 CR3 总会刷新缓存
+     */
+    static inline void SET_PGD_ASID(uintptr_t _pgd, uint16_t _asid,
+                                    bool _flush) {
+#if defined(__x86_64__)
+        uintptr_t cr3 = _pgd | (_asid & CR3_PCID_MASK);
+        if (_flush == false) {
+            cr3 |= CR3_NOFLUSH;
+        }
+        __asm__ volatile("mov %0, %%cr3" : : "r"(cr3) : "memory");
+#else
+        (void)_flush;
+        assert(_asid == 0);
+        __asm__ volatile("mov %0, %%cr3" : : "r"(_pgd) : "memory");
+#endif
+        return;
+    }
+
     /**
      * @brief 读 MSR
      * @param  _idx            要读的索引
@@ -389,6 +493,27 @@ namespace CPU {
         return;
     }
 
+    /**
+     * @brief 读时间戳计数器
+     * @return uint64_t        读到的值
+     */
+    static inline uint64_t READ_TIME(void) {
+        uint32_t low;
+        uint32_t high;
+        __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+        return ((uint64_t)high << 32) | low;
+    }
+
+    /**
+     * @brief 等待之前的读写完成
+     * @note 写入 x2APIC 的寄存器不是串行化指令，
+     * 修改定时器模式后需要先完成再写 IA32_TSC_DEADLINE
+     */
+    static inline void MFENCE(void) {
+        __asm__ volatile("mfence" : : : "memory");
+        return;
+    }
+
     /// @todo 改为 static
     class CPUID {
     private:
@@ -441,6 +566,7 @@ namespace CPU {
         static constexpr const uint32_t FEAT_ECX_x2APIC  = 1 << 21;
         static constexpr const uint32_t FEAT_ECX_MOVBE   = 1 << 22;
         static constexpr const uint32_t FEAT_ECX_POPCNT  = 1 << 23;
+        static constexpr const uint32_t FEAT_ECX_TSC_DL  = 1 << 24;
         static constexpr const uint32_t FEAT_ECX_AES     = 1 << 25;
         static constexpr const uint32_t FEAT_ECX_XSAVE   = 1 << 26;
         static constexpr const uint32_t FEAT_ECX_OSXSAVE = 1 << 27;
@@ -475,6 +601,8 @@ namespace CPU {
         static constexpr const uint32_t FEAT_EDX_TM1     = 1 << 29;
         static constexpr const uint32_t FEAT_EDX_IA64    = 1 << 30;
         static constexpr const uint32_t FEAT_EDX_PBE     = 1 << 31;
+        // 拓展功能，INTEL_FEATURES
+        static constexpr const uint32_t FEAT_EXT_EDX_PDPE1GB = 1 << 26;
         enum : uint32_t {
             GET_VENDOR = 0x00,
             GET_FEATURES,
@@ -538,11 +666,48 @@ namespace CPU {
             cpuid(GET_FEATURES, 0, &eax, &ebx, &ecx, &edx);
             return ecx & FEAT_ECX_x2APIC;
         }
+        bool tsc_deadline(void) {
+            uint32_t eax, ebx, ecx, edx;
+            cpuid(GET_FEATURES, 0, &eax, &ebx, &ecx, &edx);
+            return ecx & FEAT_ECX_TSC_DL;
+        }
+        bool pcid(void) {
+            uint32_t eax, ebx, ecx, edx;
+            cpuid(GET_FEATURES, 0, &eax, &ebx, &ecx, &edx);
+            return ecx & FEAT_ECX_PCIDE;
+        }
+        bool pdpe1gb(void) {
+            uint32_t eax, ebx, ecx, edx;
+            if (max_cpuidex < INTEL_FEATURES) {
+                return false;
+            }
+            cpuid(INTEL_FEATURES, 0, &eax, &ebx, &ecx, &edx);
+            return edx & FEAT_EXT_EDX_PDPE1GB;
+        }
         bool eoi(void) {
             uint64_t version = READ_MSR(IA32_X2APIC_VERSION);
             return version & IA32_X2APIC_SIVR_EOI_ENABLE_BIT;
         }
     };
+
+    /**
+     * @brief 开启地址空间标识(PCID)
+     * @return size_t           可用的标识数量，为 1 时只能使用 0
+     * @note 开启 PCIDE 时 CR3 的低 12 位必须为 0，需要在开启分页后调用
+     * PCID 只在 IA-32e 模式下可用
+     */
+    static inline size_t ENABLE_ASID(void) {
+#if defined(__x86_64__)
+        if (CPUID().pcid() == false) {
+            return 1;
+        }
+        assert((GET_PGD() & CR3_PCID_MASK) == 0);
+        WRITE_CR4(READ_CR4() | CR4_PCIDE);
+        return CR3_PCID_MASK + 1;
+#else
+        return 1;
+#endif
+    }
 };
 
 #endif /* _CPU_HPP_ */
@@ -323,6 +323,17 @@ public:
  * @brief 时钟抽象
  */
 class TIMER {
+private:
+    /// PIT 输入频率
+    static constexpr const uint32_t PIT_FREQ = 1193182;
+    /// PIT 通道 0 数据端口
+    static constexpr const uint32_t PIT_CH0 = 0x40;
+    /// PIT 命令端口
+    static constexpr const uint32_t PIT_CMD = 0x43;
+
+    /// 时钟中断次数
+    volatile uint32_t ticks;
+
 public:
     /**
      * @brief 获取单例
@@ -332,8 +343,33 @@ public:
 
     /**
      * @brief 初始化
+     * @note PIT 以 CLOCKEVENT::HZ 产生周期中断
      */
     void init(void);
+
+    /**
+     * @brief 获取当前时间
+     * @return uint64_t        初始化后经过的纳秒数，精度为一个周期
+     */
+    uint64_t get_time(void) const;
+
+    /**
+     * @brief 设置单次时钟
+     * @param  _ns             到期时间，与 get_time 相同的纳秒数
+     * @note 没有单次时钟，保持周期中断，事件在之后的中断中执行
+     */
+    void set_next(uint64_t _ns);
+
+    /**
+     * @brief 停止时钟
+     * @note 保持周期中断
+     */
+    void stop(void);
+
+    /**
+     * @brief 时钟中断处理
+     */
+    void handle(void);
 };
 
 #endif /* _INTR_H_ */
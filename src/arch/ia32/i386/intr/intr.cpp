@@ -21,8 +21,10 @@
 #include "gdt.h"
 #include "intr.h"
 #include "apic.h"
+#include "softirq.h"
 #include "keyboard.h"
 #include "vmm.h"
+#include "address_space.h"
 
 // 声明中断处理函数 0 ~ 19 属于 CPU 的异常中断
 // ISR:中断服务程序(interrupt service routine)
@@ -133,6 +135,23 @@ static void handler_default(INTR::intr_context_t *) {
     return;
 }
 
+// 缺页处理，由当前地址空间按虚拟内存区域分配并映射
+static void pg_fault(INTR::intr_context_t *_intr_context) {
+    uintptr_t addr = CPU::READ_CR2();
+    // W/R 位表示写访问
+    INTR::page_fault_error_code_t code;
+    memcpy(&code, &_intr_context->err_code, sizeof(code));
+    if (ADDRESS_SPACE::page_fault(addr, code.wr == 1) == true) {
+        return;
+    }
+    warn("page fault: 0x%p, eip: 0x%p, error code: 0x%X.\n", addr,
+         _intr_context->eip, _intr_context->err_code);
+    while (1) {
+        ;
+    }
+    return;
+}
+
 // 中断处理函数指针数组
 INTR::interrupt_handler_t INTR::interrupt_handlers[INTERRUPT_MAX];
 // 中断描述符表
@@ -344,12 +363,18 @@ int32_t INTR::init(void) {
     for (uint32_t i = 0; i < INTERRUPT_MAX; i++) {
         register_interrupt_handler(i, handler_default);
     }
+    // 注册缺页中断
+    register_interrupt_handler(INT_PAGE_FAULT, pg_fault);
     // idt 初始化
     init_interrupt_chip();
     // 加载 idt
     idt_load((uintptr_t)&idt_ptr);
     // APIC 初始化
     apic.init();
+    // 外部中断改由 IO APIC 发送
+    if (IO_APIC::available() == true) {
+        disable_interrupt_chip();
+    }
     // 键盘初始化
     KEYBOARD::get_instance().init();
     info("intr init.\n");
@@ -357,11 +382,18 @@ int32_t INTR::init(void) {
 }
 
 int32_t INTR::call_irq(uint8_t _no, intr_context_t *_intr_context) {
-    // 重设PIC芯片
-    clear_interrupt_chip(_no);
+    // 经过 IO APIC 的中断通知本地 APIC，否则重设PIC芯片
+    if (IO_APIC::available() == false) {
+        clear_interrupt_chip(_no);
+    }
+    else {
+        LOCAL_APIC::eoi();
+    }
     if (interrupt_handlers[_no] != nullptr) {
         interrupt_handlers[_no](_intr_context);
     }
+    // 中断返回前执行下半部，中断门保存了现场，可以允许中断嵌套
+    SOFTIRQ::get_instance().run();
     return 0;
 }
 
@@ -383,6 +415,10 @@ void INTR::register_interrupt_handler(uint8_t             _no,
 }
 
 void INTR::enable_irq(uint8_t _no) {
+    if (IO_APIC::available() == true) {
+        IO_APIC::set_mask(_no - IRQ0, false);
+        return;
+    }
     uint8_t mask = 0;
     // printk_color(green, "enable_irq mask: %X", mask);
     if (_no >= IRQ8) {
@@ -397,6 +433,10 @@ void INTR::enable_irq(uint8_t _no) {
 }
 
 void INTR::disable_irq(uint8_t _no) {
+    if (IO_APIC::available() == true) {
+        IO_APIC::set_mask(_no - IRQ0, true);
+        return;
+    }
     uint8_t mask = 0;
     // printk_color(green, "disable_irq mask: %X", mask);
     if (_no >= IRQ8) {
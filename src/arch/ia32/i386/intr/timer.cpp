@@ -19,12 +19,13 @@
 #include "cpu.hpp"
 #include "intr.h"
 #include "io.h"
+#include "clockevent.h"
 
 /**
  * @brief 时钟中断
  */
 void timer_intr(INTR::intr_context_t *) {
-    printf("timer.\n");
+    TIMER::get_instance().handle();
     return;
 }
 
@@ -35,10 +36,35 @@ TIMER &TIMER::get_instance(void) {
 }
 
 void TIMER::init(void) {
+    IO &     io      = IO::get_instance();
+    uint16_t divisor = PIT_FREQ / CLOCKEVENT::HZ;
+    ticks            = 0;
+    // 通道 0，先写低字节再写高字节，模式 2，二进制计数
+    io.outb(PIT_CMD, 0x34);
+    io.outb(PIT_CH0, divisor & 0xFF);
+    io.outb(PIT_CH0, divisor >> 8);
     // 注册中断函数
     INTR::get_instance().register_interrupt_handler(INTR::IRQ0, timer_intr);
     // 开启时钟中断
     INTR::get_instance().enable_irq(INTR::IRQ0);
-    info("timer init.\n");
+    info("timer init, hz: %d.\n", CLOCKEVENT::HZ);
+    return;
+}
+
+uint64_t TIMER::get_time(void) const {
+    return (uint64_t)ticks * CLOCKEVENT::TICK_NS;
+}
+
+void TIMER::set_next(uint64_t) {
+    return;
+}
+
+void TIMER::stop(void) {
+    return;
+}
+
+void TIMER::handle(void) {
+    ticks++;
+    CLOCKEVENT::get_instance().handle();
     return;
 }
@@ -19,7 +19,7 @@
 
 namespace GDT {
     // 加载 GDTR
-    extern "C" void gdt_load(uint32_t);
+    extern "C" void gdt_load(uint64_t);
     // 全局 gdt 指针
     static gdt_ptr64_t gdt_ptr64;
     // 全局描述符表定义
@@ -152,8 +152,8 @@ private:
     struct idt_ptr_t {
         // 限长
         uint16_t limit;
-        // 基址
-        uint32_t base;
+        // 64 位基址
+        uint64_t base;
     } __attribute__((packed));
 
     /// 中断处理函数指针数组
@@ -164,6 +164,8 @@ private:
         __attribute__((aligned(16)));
     /// IDTR
     static idt_ptr_t idt_ptr;
+    /// 正在处理的异常的错误码，没有错误码的异常为 0
+    static uint64_t err_code;
 
     /**
      * @brief 设置中断描述符
@@ -255,6 +257,8 @@ public:
     static constexpr const uint32_t IRQ15 = 47;
     // 系统调用
     static constexpr const uint32_t IRQ128 = 128;
+    // 本地 APIC 时钟，由本地 APIC 直接发送，不经过 8259A
+    static constexpr const uint32_t IRQ_APIC_TIMER = 0xEF;
 
     /**
      * @brief 获取单例
@@ -276,7 +280,21 @@ public:
      */
     int32_t call_irq(uint8_t _no, intr_context_t *_intr_context);
 
-    int32_t call_isr(uint8_t _no, intr_context_t *_intr_context);
+    /**
+     * @brief 执行异常处理
+     * @param  _no             中断号
+     * @param  _intr_context   上下文
+     * @param  _err_code       错误码
+     * @return int32_t         保存中断处理后的返回值
+     */
+    int32_t call_isr(uint8_t _no, intr_context_t *_intr_context,
+                     uint64_t _err_code);
+
+    /**
+     * @brief 获取正在处理的异常的错误码
+     * @return uint64_t        错误码
+     */
+    uint64_t get_err_code(void) const;
 
     /**
      * @brief 注册一个中断处理函数
@@ -307,8 +325,47 @@ public:
 
 /**
  * @brief 时钟抽象
+ * 使用本地 APIC 定时器，CPU 支持时使用 TSC-deadline 模式
+ * 初始化时以 PIT 为基准测量 TSC 与本地 APIC 定时器的频率
  */
 class TIMER {
+private:
+    /// 每秒的纳秒数
+    static constexpr const uint64_t NS_PER_SEC = 1000000000;
+    /// PIT 输入频率
+    static constexpr const uint32_t PIT_FREQ = 1193182;
+    /// PIT 通道 2 数据端口
+    static constexpr const uint32_t PIT_CH2 = 0x42;
+    /// PIT 命令端口
+    static constexpr const uint32_t PIT_CMD = 0x43;
+    /// 通道 2 门控与输出，bit0 门控，bit1 扬声器，bit5 通道 2 输出
+    static constexpr const uint32_t PIT_GATE = 0x61;
+    /// 测量持续的时间，单位为 ms
+    static constexpr const uint32_t CALIBRATE_MS = 10;
+
+    /// TSC 频率，单位为 Hz
+    uint64_t tsc_freq;
+    /// 本地 APIC 定时器频率，单位为 Hz
+    uint64_t apic_freq;
+    /// 是否使用 TSC-deadline 模式
+    bool deadline;
+    /// 初始化时的 TSC，作为时间的起点
+    uint64_t tsc_base;
+
+    /**
+     * @brief 以 PIT 通道 2 计时，测量 TSC 与本地 APIC 定时器的频率
+     * @note 轮询 PIT 的输出，不需要中断
+     */
+    void calibrate(void);
+
+    /**
+     * @brief 将纳秒换算为计数
+     * @param  _ns             纳秒
+     * @param  _freq           频率，单位为 Hz
+     * @return uint64_t        计数
+     */
+    static uint64_t ns2count(uint64_t _ns, uint64_t _freq);
+
 public:
     /**
      * @brief 获取单例
@@ -318,8 +375,33 @@ public:
 
     /**
      * @brief 初始化
+     * @note 不设置时钟，由 CLOCKEVENT 按需设置
      */
     void init(void);
+
+    /**
+     * @brief 获取当前时间
+     * @return uint64_t        初始化后经过的纳秒数
+     */
+    uint64_t get_time(void) const;
+
+    /**
+     * @brief 设置单次时钟
+     * @param  _ns             到期时间，与 get_time 相同的纳秒数
+     * @note 覆盖之前的设置，已经过去的时间会立即产生中断
+     */
+    void set_next(uint64_t _ns);
+
+    /**
+     * @brief 停止时钟
+     */
+    void stop(void);
+
+    /**
+     * @brief 获取 TSC 频率
+     * @return uint64_t        频率，单位为 Hz
+     */
+    uint64_t get_tsc_freq(void) const;
 };
 
 #endif /* _INTR_H_ */
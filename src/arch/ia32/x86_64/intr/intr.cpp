@@ -21,7 +21,9 @@
 #include "gdt.h"
 #include "intr.h"
 #include "apic.h"
+#include "softirq.h"
 #include "keyboard.h"
+#include "address_space.h"
 
 // 声明中断处理函数 0 ~ 19 属于 CPU 的异常中断
 // ISR:中断服务程序(interrupt service routine)
@@ -103,8 +105,10 @@ extern "C" void irq13(void);
 extern "C" void irq14(void);
 /// IDE1 传输控制使用
 extern "C" void irq15(void);
+/// 本地 APIC 时钟
+extern "C" void irq_apic_timer(void);
 /// 声明加载 IDTR 的函数
-extern "C" void idt_load(uint32_t);
+extern "C" void idt_load(uint64_t);
 
 /**
  * @brief IRQ 处理函数
@@ -118,9 +122,8 @@ extern "C" void irq_handler(uint8_t _no, INTR::intr_context_t *_intr_context) {
  * @brief ISR 处理函数
  */
 extern "C" void isr_handler(uint8_t _no, INTR::intr_context_t *_intr_context,
-                            INTR::error_code_t *_err_code) {
-    (void)_err_code;
-    INTR::get_instance().call_isr(_no, _intr_context);
+                            uint64_t _err_code) {
+    INTR::get_instance().call_isr(_no, _intr_context, _err_code);
     return;
 }
 
@@ -132,12 +135,32 @@ static void handler_default(INTR::intr_context_t *) {
     return;
 }
 
+// 缺页处理，由当前地址空间按虚拟内存区域分配并映射
+static void pg_fault(INTR::intr_context_t *_intr_context) {
+    uintptr_t addr     = CPU::READ_CR2();
+    uint64_t  err_code = INTR::get_instance().get_err_code();
+    // W/R 位表示写访问
+    INTR::page_fault_error_code_t code;
+    memcpy(&code, &err_code, sizeof(code));
+    if (ADDRESS_SPACE::page_fault(addr, code.wr == 1) == true) {
+        return;
+    }
+    warn("page fault: 0x%p, rip: 0x%p, error code: 0x%X.\n", addr,
+         _intr_context->rip, err_code);
+    while (1) {
+        ;
+    }
+    return;
+}
+
 // 中断处理函数指针数组
 INTR::interrupt_handler_t INTR::interrupt_handlers[INTERRUPT_MAX];
 // 中断描述符表
 INTR::idt_entry64_t INTR::idt_entry64[INTERRUPT_MAX];
 // IDTR
 INTR::idt_ptr_t INTR::idt_ptr;
+// 错误码
+uint64_t INTR::err_code;
 
 // 64-ia-32-architectures-software-developer-vol-3a-manual#6.14.1
 void INTR::set_idt(uint8_t _num, uintptr_t _base, uint16_t _selector,
@@ -338,6 +361,9 @@ int32_t INTR::init(void) {
     set_idt(IRQ15, (uintptr_t)irq15, GDT::SEG_KERNEL_CODE, 0x0,
             GDT::TYPE_SYSTEM_64_INTERRUPT_GATE, CPU::DPL0,
             GDT::SEGMENT_PRESENT);
+    set_idt(IRQ_APIC_TIMER, (uintptr_t)irq_apic_timer, GDT::SEG_KERNEL_CODE,
+            0x0, GDT::TYPE_SYSTEM_64_INTERRUPT_GATE, CPU::DPL0,
+            GDT::SEGMENT_PRESENT);
     // 填充系统调用中断
     set_idt(IRQ128, (uintptr_t)isr128, GDT::SEG_KERNEL_CODE, 0x0,
             GDT::TYPE_SYSTEM_64_INTERRUPT_GATE, CPU::DPL3,
@@ -346,12 +372,18 @@ int32_t INTR::init(void) {
     for (uint32_t i = 0; i < INTERRUPT_MAX; i++) {
         register_interrupt_handler(i, handler_default);
     }
+    // 注册缺页中断
+    register_interrupt_handler(INT_PAGE_FAULT, pg_fault);
     // idt 初始化
     init_interrupt_chip();
     // 加载 idt
-    idt_load((uintptr_t)&idt_ptr);
+    idt_load((uint64_t)&idt_ptr);
     // APIC 初始化
     apic.init();
+    // 外部中断改由 IO APIC 发送
+    if (IO_APIC::available() == true) {
+        disable_interrupt_chip();
+    }
     // 键盘初始化
     KEYBOARD::get_instance().init();
     info("intr init.\n");
@@ -359,15 +391,24 @@ int32_t INTR::init(void) {
 }
 
 int32_t INTR::call_irq(uint8_t _no, intr_context_t *_intr_context) {
-    // 重设PIC芯片
-    clear_interrupt_chip(_no);
+    // 经过 IO APIC 或由本地 APIC 发送的中断通知本地 APIC，否则重设PIC芯片
+    if (_no <= IRQ15 && IO_APIC::available() == false) {
+        clear_interrupt_chip(_no);
+    }
+    else {
+        LOCAL_APIC::eoi();
+    }
     if (interrupt_handlers[_no] != nullptr) {
         interrupt_handlers[_no](_intr_context);
     }
+    // 中断返回前执行下半部，中断门保存了现场，可以允许中断嵌套
+    SOFTIRQ::get_instance().run();
     return 0;
 }
 
-int32_t INTR::call_isr(uint8_t _no, intr_context_t *_intr_context) {
+int32_t INTR::call_isr(uint8_t _no, intr_context_t *_intr_context,
+                       uint64_t _err_code) {
+    err_code = _err_code;
     if (interrupt_handlers[_no] != nullptr) {
         interrupt_handlers[_no](_intr_context);
     }
@@ -385,6 +426,10 @@ void INTR::register_interrupt_handler(uint8_t             _no,
 }
 
 void INTR::enable_irq(uint8_t _no) {
+    if (IO_APIC::available() == true) {
+        IO_APIC::set_mask(_no - IRQ0, false);
+        return;
+    }
     uint8_t mask = 0;
     // printk_color(green, "enable_irq mask: %X", mask);
     if (_no >= IRQ8) {
@@ -399,6 +444,10 @@ void INTR::enable_irq(uint8_t _no) {
 }
 
 void INTR::disable_irq(uint8_t _no) {
+    if (IO_APIC::available() == true) {
+        IO_APIC::set_mask(_no - IRQ0, true);
+        return;
+    }
     uint8_t mask = 0;
     // printk_color(green, "disable_irq mask: %X", mask);
     if (_no >= IRQ8) {
@@ -412,6 +461,10 @@ void INTR::disable_irq(uint8_t _no) {
     return;
 }
 
+uint64_t INTR::get_err_code(void) const {
+    return err_code;
+}
+
 const char *INTR::get_intr_name(uint8_t _no) {
     if (_no < sizeof(intrnames) / sizeof(const char *const)) {
         return intrnames[_no];
@@ -19,12 +19,14 @@
 #include "cpu.hpp"
 #include "intr.h"
 #include "io.h"
+#include "apic.h"
+#include "clockevent.h"
 
 /**
  * @brief 时钟中断
  */
 void timer_intr(INTR::intr_context_t *) {
-    printf("timer.\n");
+    CLOCKEVENT::get_instance().handle();
     return;
 }
 
@@ -34,11 +36,82 @@ TIMER &TIMER::get_instance(void) {
     return timer;
 }
 
+uint64_t TIMER::ns2count(uint64_t _ns, uint64_t _freq) {
+    // 分为整秒与余下的部分，避免溢出
+    uint64_t count =
+        _ns / NS_PER_SEC * _freq + _ns % NS_PER_SEC * _freq / NS_PER_SEC;
+    // 计数为 0 时不会产生中断
+    return count == 0 ? 1 : count;
+}
+
+void TIMER::calibrate(void) {
+    IO &     io    = IO::get_instance();
+    uint16_t count = PIT_FREQ * CALIBRATE_MS / 1000;
+    // 打开通道 2 的门控，关闭扬声器
+    io.outb(PIT_GATE, (io.inb(PIT_GATE) & ~0x02) | 0x01);
+    // 通道 2，先写低字节再写高字节，模式 0，二进制计数
+    io.outb(PIT_CMD, 0xB0);
+    io.outb(PIT_CH2, count & 0xFF);
+    io.outb(PIT_CH2, count >> 8);
+    // 本地 APIC 定时器从最大值开始倒数，不产生中断
+    LOCAL_APIC::set_timer(INTR::IRQ_APIC_TIMER,
+                          CPU::IA32_X2APIC_LVT_TIMER_ONESHOT |
+                              CPU::IA32_X2APIC_LVT_MASK_BIT,
+                          UINT32_MAX);
+    uint64_t tsc = CPU::READ_TIME();
+    // 计数到 0 时通道 2 输出变为高电平
+    while ((io.inb(PIT_GATE) & 0x20) == 0) {
+        ;
+    }
+    tsc_freq  = (CPU::READ_TIME() - tsc) * 1000 / CALIBRATE_MS;
+    apic_freq = (uint64_t)(UINT32_MAX - LOCAL_APIC::get_timer_count()) *
+                1000 / CALIBRATE_MS;
+    LOCAL_APIC::stop_timer();
+    return;
+}
+
 void TIMER::init(void) {
-    // 注册中断函数
-    INTR::get_instance().register_interrupt_handler(INTR::IRQ0, timer_intr);
-    // 开启时钟中断
-    INTR::get_instance().enable_irq(INTR::IRQ0);
-    info("timer init.\n");
+    CPU::CPUID cpuid;
+    deadline = cpuid.tsc_deadline();
+    calibrate();
+    tsc_base = CPU::READ_TIME();
+    // 注册中断函数，本地 APIC 的中断不经过 8259A，IRQ0 保持屏蔽
+    INTR::get_instance().register_interrupt_handler(INTR::IRQ_APIC_TIMER,
+                                                    timer_intr);
+    info("timer init, tsc: %uMHz, apic timer: %uMHz, tsc-deadline: %s.\n",
+         (uint32_t)(tsc_freq / 1000000), (uint32_t)(apic_freq / 1000000),
+         deadline == true ? "on" : "off");
     return;
 }
+
+uint64_t TIMER::get_time(void) const {
+    uint64_t count = CPU::READ_TIME() - tsc_base;
+    // 分为整秒与余下的部分，避免溢出
+    return count / tsc_freq * NS_PER_SEC +
+           count % tsc_freq * NS_PER_SEC / tsc_freq;
+}
+
+void TIMER::set_next(uint64_t _ns) {
+    if (deadline == true) {
+        LOCAL_APIC::set_timer(INTR::IRQ_APIC_TIMER,
+                              CPU::IA32_X2APIC_LVT_TIMER_TSC_DEADLINE,
+                              tsc_base + ns2count(_ns, tsc_freq));
+    }
+    else {
+        // 没有 TSC-deadline 时换算为相对时间
+        uint64_t now = get_time();
+        LOCAL_APIC::set_timer(INTR::IRQ_APIC_TIMER,
+                              CPU::IA32_X2APIC_LVT_TIMER_ONESHOT,
+                              ns2count(_ns > now ? _ns - now : 0, apic_freq));
+    }
+    return;
+}
+
+void TIMER::stop(void) {
+    LOCAL_APIC::stop_timer();
+    return;
+}
+
+uint64_t TIMER::get_tsc_freq(void) const {
+    return tsc_freq;
+}
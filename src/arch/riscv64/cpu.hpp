@@ -215,14 +215,62 @@ static inline uintptr_t GET_PGD(void) {
     return x;
 }
 
+/// satp 中 ASID 字段的位置，最多 16 位
+static constexpr const uint64_t SATP_ASID_SHIFT = 44;
+static constexpr const uint64_t SATP_ASID_MASK  = (uint64_t)0xFFFF
+                                                 << SATP_ASID_SHIFT;
+
+/**
+ * @brief 设置页目录与地址空间标识(ASID)
+ * @param  _pgd             要设置的页目录
+ * @param  _asid            ASID
+ * @param  _flush           是否刷新 _asid 的 tlb
+ * @note 只在开启 sv39 后使用
+ */
+static inline void SET_PGD_ASID(uintptr_t _pgd, uint16_t _asid, bool _flush) {
+    uintptr_t x = SET_SV39(_pgd) | ((uint64_t)_asid << SATP_ASID_SHIFT);
+    __asm__ volatile("csrw satp, %0" : : "r"(x) : "memory");
+    if (_flush == true) {
+        uintptr_t asid = _asid;
+        __asm__ volatile("sfence.vma zero, %0" : : "r"(asid) : "memory");
+    }
+    return;
+}
+
+/**
+ * @brief 开启地址空间标识(ASID)
+ * @return size_t           可用的标识数量，为 1 时只能使用 0
+ * @note 向 satp 的 ASID 字段写入全 1，读回后仍为 1 的位即为实现的位
+ * 需要在开启分页后调用
+ */
+static inline size_t ENABLE_ASID(void) {
+    uintptr_t old;
+    uintptr_t x;
+    __asm__ volatile("csrr %0, satp" : "=r"(old));
+    x = old | SATP_ASID_MASK;
+    __asm__ volatile("csrw satp, %0" : : "r"(x));
+    __asm__ volatile("csrr %0, satp" : "=r"(x));
+    __asm__ volatile("csrw satp, %0" : : "r"(old));
+    x = (x & SATP_ASID_MASK) >> SATP_ASID_SHIFT;
+    // 实现的位从低位开始连续
+    size_t count = 1;
+    while ((x & 1) == 1) {
+        count <<= 1;
+        x >>= 1;
+    }
+    return count;
+}
+
 /**
  * @brief 开启分页
  * @return true             成功
  * @return false            失败
  */
 static inline bool ENABLE_PG(void) {
-    uintptr_t x = GET_PGD();
-    SET_PGD(SET_SV39(x));
+    // 启动代码已经开启了 sv39，直接写入 satp，避免 SET_PGD 重复设置模式
+    uintptr_t x = SET_SV39(GET_PGD());
+    __asm__ volatile("csrw satp, %0" : : "r"(x));
+    __asm__ volatile("sfence.vma" : : : "memory");
     info("paging enabled.\n");
     return true;
 }
@@ -290,6 +338,17 @@ static inline bool STATUS_INTR(void) {
     return (x & SSTATUS_SIE) != 0;
 }
 
+/**
+ * @brief 等待下一个中断并允许中断
+ * @note 需要在禁止中断时调用，禁止中断时 wfi 也会被挂起的中断唤醒，
+ * 允许中断后再进入中断处理，不会丢失
+ */
+static inline void WAIT_INTR(void) {
+    __asm__ volatile("wfi" ::: "memory");
+    ENABLE_INTR();
+    return;
+}
+
 /**
  * @brief 读 sp 寄存器
  * @return uint64_t         读到的值
@@ -330,11 +389,30 @@ static inline uint64_t READ_RA(void) {
 }
 
 /**
- * @brief 刷新 tlb
+ * @brief 刷新 _addr 对应的 tlb
+ * @param  _addr            要刷新的地址
+ * @note 只对叶子页表项有效，修改非叶子页表项需要 VMM_FLUSH_ALL
+ */
+static inline void VMM_FLUSH(uintptr_t _addr) {
+    __asm__ volatile("sfence.vma %0, zero" : : "r"(_addr) : "memory");
+    return;
+}
+
+/**
+ * @brief 刷新所有 tlb
  */
-static inline void VMM_FLUSH(uintptr_t) {
+static inline void VMM_FLUSH_ALL(void) {
     // the zero, zero means flush all TLB entries.
-    __asm__ volatile("sfence.vma zero, zero");
+    __asm__ volatile("sfence.vma zero, zero" : : : "memory");
+    return;
+}
+
+/**
+ * @brief 刷新所有地址空间的 tlb
+ * @note sfence.vma 的 rs2 为 zero 时已经包括所有 ASID
+ */
+static inline void VMM_FLUSH_ALL_ASID(void) {
+    VMM_FLUSH_ALL();
     return;
 }
 
@@ -30,13 +30,13 @@ CLINT &CLINT::get_instance(void) {
 }
 
 int32_t CLINT::init(void) {
-    // 映射 clint 地址
+    // 映射 clint 地址到内核高半部分，所有地址空间共享
     resource_t resource = BOOT_INFO::get_clint();
-    for (uintptr_t a = resource.mem.addr;
-         a < resource.mem.addr + resource.mem.len; a += 0x1000) {
-        VMM::get_instance().mmap(VMM::get_instance().get_pgd(), a, a,
-                                 VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
-    }
+    VMM::get_instance().mmap_range(
+        VMM::get_instance().get_pgd(), VMM_PA2VA(resource.mem.addr),
+        resource.mem.addr,
+        COMMON::ALIGN(resource.mem.len, COMMON::PAGE_SIZE),
+        VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
     // 开启内部中断
     CPU::WRITE_SIE(CPU::READ_SIE() | CPU::SIE_SSIE);
     info("clint init.\n");
@@ -17,7 +17,9 @@
 #ifndef _INTR_H_
 #define _INTR_H_
 
+#include "stddef.h"
 #include "stdint.h"
+#include "softirq.h"
 
 void handler_default(void);
 
@@ -81,6 +83,8 @@ private:
     interrupt_handler_t excp_handlers[EXCP_MAX] __attribute__((aligned(4)));
 
 public:
+    /// 取指页错误
+    static constexpr const uint8_t EXCP_INST_PAGE_FAULT = 12;
     /// 页读错误
     static constexpr const uint8_t EXCP_LOAD_PAGE_FAULT = 13;
     /// 页写错误
@@ -186,6 +190,23 @@ private:
     /// @todo ？
     uint64_t PLIC_SCLAIM(uint64_t hart);
 
+    /// 等待下半部处理的中断号数量，2 的幂
+    static constexpr const size_t QUEUE_SIZE = 32;
+    /// 等待下半部处理的中断号
+    uint8_t queue[QUEUE_SIZE];
+    /// 下一个读取的位置
+    volatile size_t queue_head;
+    /// 下一个写入的位置
+    volatile size_t queue_tail;
+    /// 下半部
+    tasklet_t tasklet;
+
+    /**
+     * @brief 下半部，处理中断号对应的设备
+     * @param  _tasklet        小任务
+     */
+    static void bottom_half(tasklet_t *_tasklet);
+
 protected:
 public:
     /**
@@ -200,6 +221,11 @@ public:
      */
     int32_t init(void);
 
+    /**
+     * @brief 外部中断的上半部，取得中断号并交给下半部
+     */
+    void handle(void);
+
     /**
      * @brief 向 PLIC 询问中断
      * 返回发生的外部中断号
@@ -226,6 +252,13 @@ public:
  * @brief 时钟抽象
  */
 class TIMER {
+private:
+    /// time 寄存器的频率
+    /// @todo 从 dts 读取
+    static constexpr const uint64_t TIMEBASE_FREQ = 10000000;
+    /// time 寄存器每个计数的纳秒数
+    static constexpr const uint64_t NS_PER_COUNT = 1000000000 / TIMEBASE_FREQ;
+
 public:
     /**
      * @brief 获取单例
@@ -235,8 +268,27 @@ public:
 
     /**
      * @brief 初始化
+     * @note 不设置时钟，由 CLOCKEVENT 按需设置
      */
     void init(void);
+
+    /**
+     * @brief 获取当前时间
+     * @return uint64_t        启动后经过的纳秒数
+     */
+    uint64_t get_time(void) const;
+
+    /**
+     * @brief 设置单次时钟
+     * @param  _ns             到期时间，与 get_time 相同的纳秒数
+     * @note 覆盖之前的设置，已经过去的时间会立即产生中断
+     */
+    void set_next(uint64_t _ns);
+
+    /**
+     * @brief 停止时钟
+     */
+    void stop(void);
 };
 
 #endif /* _INTR_H_ */
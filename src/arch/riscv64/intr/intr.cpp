@@ -19,6 +19,7 @@
 #include "intr.h"
 #include "cpu.hpp"
 #include "vmm.h"
+#include "address_space.h"
 
 /**
  * @brief 中断处理函数
@@ -46,6 +47,8 @@ extern "C" void trap_handler(uint64_t _scause, uint64_t _sepc,
 #undef DEBUG
 #endif
         // 跳转到对应的处理函数
+        // sepc 与 sstatus 没有保存在栈上，不能在中断中允许中断，
+        // 软中断在空闲循环中执行
         INTR::get_instance().do_interrupt(_scause & CPU::CAUSE_CODE_MASK);
     }
     else {
@@ -66,26 +69,42 @@ extern "C" void trap_handler(uint64_t _scause, uint64_t _sepc,
 extern "C" void trap_entry(void);
 
 /**
- * @brief 缺页处理
+ * @brief 缺页处理，由当前地址空间按虚拟内存区域分配并映射
+ * @param  _write          是否为写访问
  */
-void pg_load_excp(void) {
+static void pg_fault(bool _write) {
     uintptr_t addr = CPU::READ_STVAL();
-    // 映射页
-    VMM::get_instance().mmap(VMM::get_instance().get_pgd(), addr, addr,
-                             VMM_PAGE_READABLE);
-    info("pg_load_excp done: 0x%p.\n", addr);
+    if (ADDRESS_SPACE::page_fault(addr, _write) == true) {
+        return;
+    }
+    warn("page fault: 0x%p, sepc: 0x%p.\n", addr, CPU::READ_SEPC());
+    while (1) {
+        ;
+    }
+    return;
+}
+
+/**
+ * @brief 取指缺页处理
+ */
+void pg_inst_excp(void) {
+    pg_fault(false);
     return;
 }
 
 /**
- * @brief 缺页处理
+ * @brief 读缺页处理
+ */
+void pg_load_excp(void) {
+    pg_fault(false);
+    return;
+}
+
+/**
+ * @brief 写缺页处理
  */
 void pg_store_excp(void) {
-    uintptr_t addr = CPU::READ_STVAL();
-    // 映射页
-    VMM::get_instance().mmap(VMM::get_instance().get_pgd(), addr, addr,
-                             VMM_PAGE_WRITABLE | VMM_PAGE_READABLE);
-    info("pg_store_excp done: 0x%p.\n", addr);
+    pg_fault(true);
     return;
 }
 
@@ -122,6 +141,8 @@ int32_t INTR::init(void) {
         i = handler_default;
     }
     // 注册缺页中断
+    register_excp_handler(EXCP_INST_PAGE_FAULT, pg_inst_excp);
+    // 注册缺页中断
     register_excp_handler(EXCP_LOAD_PAGE_FAULT, pg_load_excp);
     // 注册缺页中断
     register_excp_handler(EXCP_STORE_PAGE_FAULT, pg_store_excp);
@@ -19,26 +19,14 @@
 #include "cpu.hpp"
 #include "opensbi.h"
 #include "intr.h"
-
-/// timer interrupt interval
-/// @todo 从 dts 读取
-static constexpr const uint64_t INTERVAL = 390000000 / 20;
-
-/**
- * @brief 设置下一次时钟
- */
-void set_next(void) {
-    // 调用 opensbi 提供的接口设置时钟
-    OPENSBI::get_instance().set_timer(CPU::READ_TIME() + INTERVAL);
-    return;
-}
+#include "clockevent.h"
 
 /**
  * @brief 时钟中断
  */
 void timer_intr(void) {
-    // 每次执行中断时设置下一次中断的时间
-    set_next();
+    // 执行到期的事件，由 CLOCKEVENT 设置下一次中断的时间
+    CLOCKEVENT::get_instance().handle();
     return;
 }
 
@@ -51,10 +39,26 @@ TIMER &TIMER::get_instance(void) {
 void TIMER::init(void) {
     // 注册中断函数
     INTR::get_instance().register_interrupt_handler(INTR::INTR_S_TIMER, timer_intr);
-    // 设置初次中断
-    OPENSBI::get_instance().set_timer(CPU::READ_TIME());
+    // 在设置时钟前不产生中断
+    stop();
     // 开启时钟中断
     CPU::WRITE_SIE(CPU::READ_SIE() | CPU::SIE_STIE);
     info("timer init.\n");
     return;
 }
+
+uint64_t TIMER::get_time(void) const {
+    return CPU::READ_TIME() * NS_PER_COUNT;
+}
+
+void TIMER::set_next(uint64_t _ns) {
+    // 调用 opensbi 提供的接口设置时钟，向上取整，不会提前到期
+    OPENSBI::get_instance().set_timer((_ns + NS_PER_COUNT - 1) / NS_PER_COUNT);
+    return;
+}
+
+void TIMER::stop(void) {
+    // 设置为最大值，不再产生中断
+    OPENSBI::get_instance().set_timer(UINT64_MAX);
+    return;
+}
@@ -22,6 +22,7 @@
 #include "common.h"
 #include "boot_info.h"
 #include "resource.h"
+#include "vmm.h"
 #include "dtb.h"
 
 // 所有节点
@@ -366,8 +367,10 @@ DTB &DTB::get_instance(void) {
 }
 
 bool DTB::dtb_init(void) {
+    // 通过直接映射区访问
+    uintptr_t addr = VMM_PA2VA(BOOT_INFO::boot_info_addr);
     // 头信息
-    dtb_info.header = (fdt_header_t *)BOOT_INFO::boot_info_addr;
+    dtb_info.header = (fdt_header_t *)addr;
     // 魔数
     assert(be32toh(dtb_info.header->magic) == FDT_MAGIC);
     // 版本
@@ -376,14 +379,12 @@ bool DTB::dtb_init(void) {
     BOOT_INFO::boot_info_size = be32toh(dtb_info.header->totalsize);
     // 内存保留区
     dtb_info.reserved =
-        (fdt_reserve_entry_t *)(BOOT_INFO::boot_info_addr +
+        (fdt_reserve_entry_t *)(addr +
                                 be32toh(dtb_info.header->off_mem_rsvmap));
     // 数据区
-    dtb_info.data =
-        BOOT_INFO::boot_info_addr + be32toh(dtb_info.header->off_dt_struct);
+    dtb_info.data = addr + be32toh(dtb_info.header->off_dt_struct);
     // 字符区
-    dtb_info.str =
-        BOOT_INFO::boot_info_addr + be32toh(dtb_info.header->off_dt_strings);
+    dtb_info.str = addr + be32toh(dtb_info.header->off_dt_strings);
     // 检查保留内存
     dtb_mem_reserved();
     // 初始化 map
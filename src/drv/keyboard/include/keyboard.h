@@ -20,6 +20,7 @@
 
 #include "stdint.h"
 #include "intr.h"
+#include "softirq.h"
 
 /**
  * @brief 键盘接口
@@ -610,6 +611,20 @@ private:
     bool ctrl;
     bool num;
     bool alt;
+    /// 中断中读到的扫描码，由下半部处理
+    uint8_t buf[KB_BUFSIZE];
+    /// 下一个读取的位置
+    volatile uint32_t buf_head;
+    /// 下一个写入的位置
+    volatile uint32_t buf_tail;
+    /// 下半部
+    tasklet_t tasklet;
+
+    /**
+     * @brief 下半部，处理缓冲区中的扫描码
+     * @param  _tasklet        小任务
+     */
+    static void bottom_half(tasklet_t *_tasklet);
 
 protected:
 public:
@@ -629,8 +644,13 @@ public:
     int32_t init(void);
 
     /**
-     * @brief 从键盘读
-     * @return uint8_t         读到的数据
+     * @brief 键盘中断的上半部，读取扫描码放入缓冲区
+     */
+    void handle(void);
+
+    /**
+     * @brief 处理缓冲区中的一个扫描码并回显
+     * @return uint8_t         对应的字符，缓冲区为空时返回 0
      */
     uint8_t read(void);
 
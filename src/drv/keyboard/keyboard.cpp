@@ -25,16 +25,19 @@
  * @brief 默认处理函数
  */
 static void default_keyboard_handle(INTR::intr_context_t *) {
-    KEYBOARD::get_instance().read();
+    KEYBOARD::get_instance().handle();
     return;
 }
 
 KEYBOARD::KEYBOARD(void) {
-    shift = false;
-    caps  = false;
-    ctrl  = false;
-    num   = true;
-    alt   = false;
+    shift    = false;
+    caps     = false;
+    ctrl     = false;
+    num      = true;
+    alt      = false;
+    buf_head = 0;
+    buf_tail = 0;
+    SOFTIRQ::init_tasklet(&tasklet, bottom_half, nullptr);
     return;
 }
 
@@ -42,8 +45,32 @@ KEYBOARD::~KEYBOARD(void) {
     return;
 }
 
-uint8_t KEYBOARD::read(void) {
+void KEYBOARD::bottom_half(tasklet_t *) {
+    KEYBOARD &keyboard = get_instance();
+    while (keyboard.buf_head != keyboard.buf_tail) {
+        keyboard.read();
+    }
+    return;
+}
+
+void KEYBOARD::handle(void) {
     uint8_t scancode = IO::get_instance().inb(KB_DATA);
+    // 缓冲区满时丢弃
+    if (buf_tail - buf_head < KB_BUFSIZE) {
+        buf[buf_tail % KB_BUFSIZE] = scancode;
+        buf_tail                   = buf_tail + 1;
+    }
+    SOFTIRQ::get_instance().schedule(&tasklet);
+    return;
+}
+
+uint8_t KEYBOARD::read(void) {
+    // 只有中断中写入，读取不需要禁止中断
+    if (buf_head == buf_tail) {
+        return '\0';
+    }
+    uint8_t scancode = buf[buf_head % KB_BUFSIZE];
+    buf_head         = buf_head + 1;
     // 判断是否出错
     if (!scancode) {
         warn("scancode error.\n");
@@ -331,6 +331,16 @@ public:
      * @return false           失败
      */
     static bool get_memory(const iter_data_t *_iter_data, void *_data);
+
+    /**
+     * @brief 获取 ACPI 信息
+     * @param  _iter_data      迭代变量
+     * @param  _data           数据
+     * @return true            找到 ACPI 2.0 的 RSDP
+     * @return false           继续查找
+     * @note 只有 ACPI 1.0 的 RSDP 时使用 1.0 的
+     */
+    static bool get_acpi(const iter_data_t *_iter_data, void *_data);
 };
 
 namespace BOOT_INFO {
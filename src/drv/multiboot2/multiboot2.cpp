@@ -17,6 +17,7 @@
 #include "assert.h"
 #include "stdio.h"
 #include "common.h"
+#include "vmm.h"
 #include "multiboot2.h"
 #include "boot_info.h"
 #include "resource.h"
@@ -28,7 +29,8 @@ MULTIBOOT2 &MULTIBOOT2::get_instance(void) {
 }
 
 bool MULTIBOOT2::multiboot2_init(void) {
-    uintptr_t addr = BOOT_INFO::boot_info_addr;
+    // 通过直接映射区访问
+    uintptr_t addr = VMM_PA2VA(BOOT_INFO::boot_info_addr);
     // 判断魔数是否正确
     assert(BOOT_INFO::multiboot2_magic == MULTIBOOT2_BOOTLOADER_MAGIC);
     assert((reinterpret_cast<uintptr_t>(addr) & 7) == 0);
@@ -40,7 +42,7 @@ bool MULTIBOOT2::multiboot2_init(void) {
 /// @todo 优化
 void MULTIBOOT2::multiboot2_iter(bool (*_fun)(const iter_data_t *, void *),
                                  void *_data) {
-    uintptr_t addr = BOOT_INFO::boot_info_addr;
+    uintptr_t addr = VMM_PA2VA(BOOT_INFO::boot_info_addr);
     // 下一字节开始为 tag 信息
     iter_data_t *tag = (iter_data_t *)(addr + 8);
     for (; tag->type != MULTIBOOT_TAG_TYPE_END;
@@ -88,6 +90,22 @@ bool MULTIBOOT2::get_memory(const iter_data_t *_iter_data, void *_data) {
     return true;
 }
 
+// RSDP 的副本保存在 tag 中
+bool MULTIBOOT2::get_acpi(const iter_data_t *_iter_data, void *_data) {
+    if (_iter_data->type != MULTIBOOT2::MULTIBOOT_TAG_TYPE_ACPI_OLD &&
+        _iter_data->type != MULTIBOOT2::MULTIBOOT_TAG_TYPE_ACPI_NEW) {
+        return false;
+    }
+    resource_t *resource = (resource_t *)_data;
+    MULTIBOOT2::multiboot_tag_new_acpi_t *tag =
+        (MULTIBOOT2::multiboot_tag_new_acpi_t *)_iter_data;
+    resource->type |= resource_t::MEM;
+    resource->name     = (char *)"acpi rsdp";
+    resource->mem.addr = (uintptr_t)tag->rsdp;
+    resource->mem.len  = tag->size - sizeof(iter_data_t);
+    return _iter_data->type == MULTIBOOT2::MULTIBOOT_TAG_TYPE_ACPI_NEW;
+}
+
 namespace BOOT_INFO {
 // 地址
 uintptr_t boot_info_addr;
@@ -116,4 +134,11 @@ resource_t get_memory(void) {
                                                &resource);
     return resource;
 }
+
+resource_t get_acpi(void) {
+    resource_t resource;
+    MULTIBOOT2::get_instance().multiboot2_iter(MULTIBOOT2::get_acpi,
+                                               &resource);
+    return resource;
+}
 }; // namespace BOOT_INFO
@@ -20,6 +20,7 @@
 #include "stdint.h"
 #include "stddef.h"
 #include "color.h"
+#include "vmm.h"
 
 /**
  * @brief 位置信息
@@ -105,8 +106,8 @@ private:
     /// 规定显示列数
     /// @todo 从 grub 获取
     static constexpr const size_t HEIGHT = 25;
-    // TUI 缓存
-    char_t *const buffer = (char_t *)TUI_MEM_BASE;
+    // TUI 缓存，通过直接映射区访问
+    char_t *const buffer = (char_t *)VMM_PA2VA(TUI_MEM_BASE);
     /// 记录当前位置
     static pos_t pos;
     /// 记录当前命令行颜色
@@ -33,7 +33,7 @@ namespace BOOT_INFO {
 /// 声明，定义在具体的实现中
 /// 是否已经初始化过
 extern bool inited;
-/// 地址
+/// 地址，为物理地址，通过直接映射区访问
 extern "C" uintptr_t boot_info_addr;
 /// 长度
 extern size_t boot_info_size;
@@ -51,6 +51,12 @@ extern bool init(void);
  */
 extern resource_t get_memory(void);
 
+/**
+ * @brief 获取 ACPI 信息
+ * @return resource_t       mem.addr 为 RSDP 的地址，没有时为 0
+ */
+extern resource_t get_acpi(void);
+
 /**
  * @brief 获取 clint 信息
  * @return resource_t       clint 资源信息
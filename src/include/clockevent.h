@@ -0,0 +1,151 @@
+/**
+ * @file clockevent.h
+ * @brief 时钟事件头文件
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#ifndef _CLOCKEVENT_H_
+#define _CLOCKEVENT_H_
+
+#include "stddef.h"
+#include "stdint.h"
+#include "map"
+#include "pool_allocator"
+
+/**
+ * @brief 时钟事件
+ */
+struct clock_event_t {
+    /// 到期时间，单位为纳秒
+    uint64_t expires;
+    /// 到期时调用，可以在其中重新添加
+    void (*handler)(clock_event_t *_event);
+    /// 私有数据
+    void *data;
+    /// 是否在等待到期
+    bool pending;
+};
+
+/**
+ * @brief 时钟事件管理
+ * 按到期时间保存所有等待的事件，只为最早的一个设置单次时钟
+ * 周期时钟也是其中的一个事件，空闲时移除，没有其它事件时不产生时钟中断
+ * @note 依赖架构提供的 TIMER::get_time/set_next/stop
+ * 不支持单次时钟的架构保持周期中断，这里只按到期时间处理事件
+ */
+class CLOCKEVENT {
+private:
+    /// 等待的事件，以到期时间为键，节点从池中分配，添加与删除不经过堆
+    mystl::multimap<
+        uint64_t, clock_event_t *, mystl::less<uint64_t>,
+        mystl::pool_allocator<mystl::pair<const uint64_t, clock_event_t *>>>
+        events;
+    /// 已经设置的到期时间，UINT64_MAX 表示没有设置
+    uint64_t next;
+    /// 周期时钟
+    clock_event_t tick;
+    /// 周期时钟次数
+    uint64_t ticks;
+    /// 时钟中断次数
+    uint64_t wakeups;
+    /// 是否空闲
+    bool idle;
+    /// 是否正在执行到期的事件，此时由 handle 在最后统一设置时钟
+    bool handling;
+
+    /**
+     * @brief 周期时钟
+     * @param  _event          周期时钟事件
+     */
+    static void tick_handler(clock_event_t *_event);
+
+    /**
+     * @brief 从等待的事件中移除
+     * @param  _event          要移除的事件
+     * @note 需要在禁止中断时调用
+     */
+    void remove(clock_event_t *_event);
+
+    /**
+     * @brief 为最早的事件设置单次时钟，没有事件时停止时钟
+     * @note 需要在禁止中断时调用
+     */
+    void program(void);
+
+public:
+    /// 每秒的纳秒数
+    static constexpr const uint64_t NS_PER_SEC = 1000000000;
+    /// 周期时钟频率
+    static constexpr const uint32_t HZ = 100;
+    /// 周期时钟间隔，单位为纳秒
+    static constexpr const uint64_t TICK_NS = NS_PER_SEC / HZ;
+
+    CLOCKEVENT(void);
+    ~CLOCKEVENT(void);
+
+    /**
+     * @brief 获取单例
+     * @return CLOCKEVENT&      静态对象
+     */
+    static CLOCKEVENT &get_instance(void);
+
+    /**
+     * @brief 初始化，开始周期时钟
+     * @note 需要在 TIMER 初始化后调用
+     */
+    void init(void);
+
+    /**
+     * @brief 获取当前时间
+     * @return uint64_t        单调递增的纳秒数
+     */
+    uint64_t get_time(void) const;
+
+    /**
+     * @brief 添加事件，已经在等待的事件更新到期时间
+     * @param  _event          要添加的事件，需要设置 expires 与 handler
+     */
+    void add(clock_event_t *_event);
+
+    /**
+     * @brief 删除事件
+     * @param  _event          要删除的事件
+     * @return true            事件在等待中，已经删除
+     * @return false           事件不在等待中
+     */
+    bool del(clock_event_t *_event);
+
+    /**
+     * @brief 时钟中断处理，执行到期的事件并设置下一次时钟
+     */
+    void handle(void);
+
+    /**
+     * @brief 空闲，停止周期时钟并等待中断
+     * @note 返回时中断已允许，周期时钟已恢复
+     */
+    void wait_idle(void);
+
+    /**
+     * @brief 获取周期时钟次数
+     * @return uint64_t        次数
+     */
+    uint64_t get_ticks(void) const;
+
+    /**
+     * @brief 获取时钟中断次数
+     * @return uint64_t        次数
+     */
+    uint64_t get_wakeups(void) const;
+};
+
+#endif /* _CLOCKEVENT_H_ */
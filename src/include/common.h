@@ -29,6 +29,10 @@ namespace COMMON {
     extern "C" void *kernel_text_start[];
     /// 内核代码段结束
     extern "C" void *kernel_text_end[];
+    /// 内核只读数据段开始
+    extern "C" void *kernel_rodata_start[];
+    /// 内核只读数据段结束
+    extern "C" void *kernel_rodata_end[];
     /// 内核数据段开始
     extern "C" void *kernel_data_start[];
     /// 内核数据段结束
@@ -45,6 +49,12 @@ namespace COMMON {
     /// 内核代码段结束
     static const uintptr_t KERNEL_TEXT_END_ADDR __attribute__((unused)) =
         reinterpret_cast<uintptr_t>(kernel_text_end);
+    /// 内核只读数据段开始
+    static const uintptr_t KERNEL_RODATA_START_ADDR __attribute__((unused)) =
+        reinterpret_cast<uintptr_t>(kernel_rodata_start);
+    /// 内核只读数据段结束
+    static const uintptr_t KERNEL_RODATA_END_ADDR __attribute__((unused)) =
+        reinterpret_cast<uintptr_t>(kernel_rodata_end);
     /// 内核数据段开始
     static const uintptr_t KERNEL_DATA_START_ADDR __attribute__((unused)) =
         reinterpret_cast<uintptr_t>(kernel_data_start);
@@ -0,0 +1,640 @@
+/**
+ * @file address_space.h
+ * @brief 地址空间头文件
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#ifndef _ADDRESS_SPACE_H_
+#define _ADDRESS_SPACE_H_
+
+#include "stddef.h"
+#include "stdint.h"
+#include "map"
+#include "list"
+#include "set"
+#include "pool_allocator"
+#include "vmm.h"
+
+/**
+ * @brief 填充一页数据
+ * @param  _page           要填充的页，已经按页对齐
+ * @param  _off            这一页在区域中的偏移
+ * @param  _data           注册时给出的参数
+ * @return true            成功
+ * @return false           失败
+ */
+typedef bool (*vma_fill_t)(void *_page, size_t _off, void *_data);
+
+/**
+ * @brief 虚拟内存区域，描述地址空间中保留的一段地址
+ * 区域中的页在首次访问时才分配并映射
+ */
+struct vma_t {
+    /// 后备类型
+    enum type_t : uint8_t {
+        /// 匿名内存，分配新页并清零
+        ANON,
+        /// 物理内存，映射 pa 开始的对应页，如设备内存
+        PHYS,
+        /// 分配新页并由 fill 填充，目前没有文件系统，由调用者提供数据
+        FILE,
+    };
+    /// 起始地址，按页对齐
+    uintptr_t start;
+    /// 结束地址(不含)，按页对齐
+    uintptr_t end;
+    /// 映射属性
+    uint32_t flag;
+    /// 后备类型
+    type_t type;
+    /// PHYS: 起始地址对应的物理地址
+    uintptr_t pa;
+    /// FILE: 起始地址在数据中的偏移，拆分区域后不为 0
+    size_t off;
+    /// FILE: 填充函数
+    vma_fill_t fill;
+    /// FILE: 填充函数的参数
+    void *data;
+};
+
+/**
+ * @brief 相同页合并的统计信息
+ */
+struct merge_stat_t {
+    /// 扫描过的页数
+    size_t scanned;
+    /// 合并的页数，每合并一页节省一个物理页
+    size_t merged;
+    /// 完成的轮数
+    size_t passes;
+    /// 扫描花费的时间，单位为 CPU::READ_TIME 的计数
+    uint64_t time;
+};
+
+/**
+ * @brief 地址空间
+ * 每个地址空间有自己的页目录，内核的映射由所有地址空间共享
+ * 保留的地址由虚拟内存区域描述，缺页时按区域的后备类型分配并映射
+ * 复制时私有的页以只读方式共享，写入时复制
+ * 匿名区域的读缺页映射共享的零页，写入时才分配私有的页
+ * 缺页分配的页加入全局的活跃/非活跃 LRU 链表，定期扫描页表项的已使用位
+ * 在两个链表间移动，活跃的页数即为工作集的估计，内存不足时回收不活跃的页
+ * 匿名区域中填满或频繁访问的大页范围在后台合并为一个大页，
+ * 部分取消映射或修改属性时重新拆分
+ * 开启合并后，后台扫描内容相同的不活跃匿名页，合并为一个只读的共享页
+ * 切换时使用 ASID(riscv)/PCID(x86_64) 区分 TLB 项，不需要刷新全部缓存
+ * @note ASID 按代分配，一代用完后进入下一代并刷新所有缓存，
+ * 之前分配的 ASID 在下次切换时重新分配
+ */
+class ADDRESS_SPACE {
+private:
+    /// 内核地址空间固定使用的 ASID，不会分配给其它地址空间
+    static constexpr const uint16_t ASID_KERNEL = 0;
+
+    /// 硬件支持的 ASID 数量，为 1 时不使用 ASID，每次切换都刷新缓存
+    static size_t asid_count;
+    /// 当前代下一个要分配的 ASID
+    static size_t asid_next;
+    /// 当前代数，从 1 开始
+    static uint64_t asid_generation;
+    /// 正在使用的地址空间
+    static ADDRESS_SPACE *current;
+    /// 全为 0 的只读页，由所有匿名区域的读缺页共享，不会被释放
+    static uintptr_t zero_page;
+
+    /// LRU 链表中的页
+    struct lru_page_t {
+        /// 所属的地址空间
+        ADDRESS_SPACE *as;
+        /// 虚拟地址
+        uintptr_t va;
+        /// 是否在活跃链表中
+        bool active;
+        /// 是否为合并后的大页
+        bool huge;
+        /// 曾经被写入过，复制地址空间时新页表项的已修改位为 0，需要单独记录
+        bool dirty;
+    };
+    /// LRU 链表，表头是最久没有被访问的页，缺页与回收时频繁插入删除，节点从池中分配
+    typedef mystl::list<lru_page_t, mystl::pool_allocator<lru_page_t>>
+        lru_list_t;
+    /// 以虚拟地址为键的 LRU 链表位置，节点从池中分配
+    typedef mystl::map<uintptr_t, lru_list_t::iterator, mystl::less<uintptr_t>,
+                       mystl::pool_allocator<
+                           mystl::pair<const uintptr_t, lru_list_t::iterator>>>
+        lru_map_t;
+
+    /// 相同页合并中第一次遇到的候选页
+    struct merge_item_t {
+        /// 所属的地址空间
+        ADDRESS_SPACE *as;
+        /// 虚拟地址
+        uintptr_t va;
+    };
+
+    /// 是否开启相同页合并
+    static bool merge_enabled;
+    /// 合并扫描到的地址空间，nullptr 表示开始新的一轮
+    static ADDRESS_SPACE *merge_as;
+    /// 合并扫描到的地址
+    static uintptr_t merge_va;
+
+    /// 回收失败时一次回收的页数
+    static constexpr const size_t RECLAIM_BATCH = 32;
+    /// 没有填满的大页范围中至少有这么多活跃的页时也进行合并
+    static constexpr const size_t HUGE_HOT_PAGES = VMM_PAGES_PRE_PAGE_TABLE / 2;
+
+    /// 页目录
+    pt_t pgd;
+    /// 虚拟内存区域，以起始地址为键
+    mystl::map<uintptr_t, vma_t> vmas;
+    /// 这个地址空间在 LRU 链表中的页，以虚拟地址为键
+    lru_map_t lru_pages;
+    /// 在活跃链表中的页数，大页按 4KB 计算
+    size_t active_pages;
+    /// 在 LRU 链表中的页数，大页按 4KB 计算
+    size_t resident_pages;
+    /// 压缩保存的页数
+    size_t swapped_pages;
+    /// 分配的 ASID
+    uint16_t asid;
+    /// asid 所属的代数，与 asid_generation 不同时需要重新分配，0 表示未分配
+    uint64_t generation;
+
+    /**
+     * @brief 构造内核地址空间
+     * @param  _pgd            内核页目录
+     */
+    explicit ADDRESS_SPACE(pt_t _pgd);
+
+    /**
+     * @brief 在当前代中分配 ASID
+     * @return true            发生了回绕，需要刷新所有地址空间的缓存
+     * @return false           没有回绕
+     */
+    bool new_asid(void);
+
+    /**
+     * @brief 页目录在不使用时被修改，已缓存的项失效，放弃当前的 ASID
+     */
+    void invalidate(void);
+
+    /**
+     * @brief 判断属性能否作为叶子页表项的属性
+     * @param  _flag           映射属性
+     * @return true            可以
+     * @return false           不可以
+     * @note riscv 中 R/W/X 都为 0 的页表项指向下一级页表，W 不能单独设置，
+     * 写时复制会去掉 W，因此必须可读，或只可执行
+     */
+    static constexpr bool is_leaf_flag(uint32_t _flag) {
+#if defined(__riscv)
+        return ((_flag & VMM_PAGE_READABLE) != 0) ||
+               ((_flag & VMM_PAGE_EXECUTABLE) != 0 &&
+                (_flag & VMM_PAGE_WRITABLE) == 0);
+#else
+        (void)_flag;
+        return true;
+#endif
+    }
+
+    /**
+     * @brief 添加虚拟内存区域
+     * @param  _vma            要添加的区域
+     * @return true            成功
+     * @return false           与已有的区域重叠，或属性无效
+     */
+    bool insert_vma(const vma_t &_vma);
+
+    /**
+     * @brief 取消区域中已经建立的映射，释放区域分配的页
+     * @param  _vma            区域
+     */
+    void release_vma(const vma_t &_vma);
+
+    /**
+     * @brief 获取共享页的引用计数表
+     * @return mystl::map<uintptr_t, size_t>&  以物理地址为键的引用计数
+     * @note 只记录被多个地址空间映射的页，不在表中的页只有一个使用者
+     * 第一次使用时才构造，此时堆已经初始化
+     */
+    static mystl::map<uintptr_t, size_t> &get_page_refs(void);
+
+    /**
+     * @brief 增加一个映射 _pa 的地址空间
+     * @param  _pa             物理页
+     */
+    static void ref_page(uintptr_t _pa);
+
+    /**
+     * @brief 减少一个映射 _pa 的地址空间，没有使用者时释放
+     * @param  _pa             物理页
+     */
+    static void unref_page(uintptr_t _pa);
+
+    /**
+     * @brief 处理对只读共享页的写入
+     * @param  _vma            所在的区域
+     * @param  _va             页的虚拟地址
+     * @param  _pa             页的物理地址
+     * @return true            已经映射为可写
+     * @return false           内存不足
+     * @note 零页分配新页，还有其它使用者时复制一份，否则直接恢复写权限
+     */
+    bool copy_on_write(const vma_t &_vma, uintptr_t _va, uintptr_t _pa);
+
+    /**
+     * @brief 获取 LRU 链表
+     * @param  _active         是否为活跃链表
+     * @return lru_list_t&     链表
+     * @note 第一次使用时才构造，此时堆已经初始化
+     */
+    static lru_list_t &get_lru(bool _active);
+
+    /**
+     * @brief 将新映射的页加入非活跃链表尾部，再次被访问后才进入活跃链表
+     * @param  _va             页的虚拟地址
+     * @param  _dirty          是否已经被写入过
+     */
+    void lru_add(uintptr_t _va, bool _dirty);
+
+    /**
+     * @brief 将 [_start, _end) 中的页移出 LRU 链表
+     * @param  _start          起始地址
+     * @param  _end            结束地址(不含)
+     */
+    void lru_del(uintptr_t _start, uintptr_t _end);
+
+    /**
+     * @brief 将页移到 _active 链表的尾部
+     * @param  _it             页
+     * @param  _active         是否移到活跃链表
+     */
+    static void lru_move(lru_list_t::iterator _it, bool _active);
+
+    /**
+     * @brief 尝试丢弃不活跃的页，之后的访问会重新缺页
+     * @param  _it             页
+     * @return true            已丢弃
+     * @return false           与其它地址空间共享，或无法压缩保存
+     * @note 内容全为 0 的匿名页与没有被写入过的填充页直接丢弃，
+     * 其它页压缩后保存在 ZRAM 中，缺页时解压
+     */
+    bool drop_page(lru_list_t::iterator _it);
+
+    /**
+     * @brief 获取所有地址空间，用于后台合并大页
+     * @return mystl::set<ADDRESS_SPACE *>&  地址空间
+     * @note 第一次使用时才构造，此时堆已经初始化
+     */
+    static mystl::set<ADDRESS_SPACE *> &get_spaces(void);
+
+    /**
+     * @brief 尝试将 _va 开始的大页范围合并为一个大页
+     * @param  _va             虚拟地址，按大页对齐
+     * @return true            已合并
+     * @return false           不在一个匿名区域中、有共享的页，
+     * 或没有填满也不够活跃
+     * @note 没有映射的页与零页在大页中清零
+     */
+    bool collapse_huge(uintptr_t _va);
+
+    /**
+     * @brief 如果 _va 位于合并后的大页中，将其拆分为 4KB 页
+     * @param  _va             虚拟地址
+     * @note 拆分后的页仍在原来的 LRU 链表中
+     */
+    void split_huge(uintptr_t _va);
+
+    /**
+     * @brief 拆分只有一部分在 [_va, _va + _len) 中的大页
+     * @param  _va             起始地址
+     * @param  _len            长度，单位为 bytes
+     */
+    void split_edges(uintptr_t _va, size_t _len);
+
+    /**
+     * @brief 获取已合并的页，内容不会再改变
+     * @return mystl::map<uint32_t, uintptr_t>&  以内容的哈希为键的物理页
+     * @note 所有使用者都复制了自己的页后项失效，使用时检查引用计数
+     */
+    static mystl::map<uint32_t, uintptr_t> &get_merge_stable(void);
+
+    /**
+     * @brief 获取本轮扫描中遇到的候选页，内容可能改变，每轮清空
+     * @return mystl::map<uint32_t, merge_item_t>&  以内容的哈希为键的候选页
+     */
+    static mystl::map<uint32_t, merge_item_t> &get_merge_unstable(void);
+
+    /// 相同页合并的统计信息
+    static merge_stat_t merge_stats;
+
+    /**
+     * @brief 计算页内容的哈希，FNV-1a 按 32 位处理
+     * @param  _data           页的内容
+     * @return uint32_t        哈希值
+     */
+    static uint32_t hash_page(const void *_data);
+
+    /**
+     * @brief 查找 _va 之后第一个匿名区域中已映射的页
+     * @param  _va             起始地址，返回时为找到的页的地址
+     * @param  _pa             保存找到的页的物理地址
+     * @return true            找到
+     * @return false           之后没有
+     */
+    bool next_anon_page(uintptr_t &_va, uintptr_t &_pa);
+
+    /**
+     * @brief 尝试将 _va 的页与内容相同的页合并
+     * @param  _va             虚拟地址
+     * @param  _pa             物理地址
+     * @return true            已合并
+     * @return false           不是独占的不活跃页，或没有找到相同的页
+     */
+    bool merge_page(uintptr_t _va, uintptr_t _pa);
+
+    /**
+     * @brief 将 _va 改为以只读方式映射 _shared，并释放原来的页
+     * @param  _va             虚拟地址
+     * @param  _pa             原来的物理页
+     * @param  _shared         内容相同的物理页
+     * @note 写入时由写时复制重新分配
+     */
+    void share_page(uintptr_t _va, uintptr_t _pa, uintptr_t _shared);
+
+    /**
+     * @brief 分配缺页使用的物理页，内存不足时先回收不活跃的页
+     * @return uintptr_t       物理页，失败返回 0
+     */
+    static uintptr_t alloc_user_page(void);
+
+protected:
+public:
+    /**
+     * @brief 构造新的地址空间，只包含内核的映射
+     */
+    ADDRESS_SPACE(void);
+    ADDRESS_SPACE(const ADDRESS_SPACE &) = delete;
+    ADDRESS_SPACE &operator=(const ADDRESS_SPACE &) = delete;
+
+    /**
+     * @brief 释放所有区域、页目录与其独有的页表
+     * @note 不能是正在使用的地址空间
+     */
+    ~ADDRESS_SPACE(void);
+
+    /**
+     * @brief 初始化，开启 ASID，需要在开启分页并初始化堆后调用
+     * @return true            成功
+     * @return false           失败
+     */
+    static bool init(void);
+
+    /**
+     * @brief 获取内核地址空间
+     * @return ADDRESS_SPACE&  内核地址空间
+     */
+    static ADDRESS_SPACE &get_kernel(void);
+
+    /**
+     * @brief 获取正在使用的地址空间
+     * @return ADDRESS_SPACE&  正在使用的地址空间
+     */
+    static ADDRESS_SPACE &get_current(void);
+
+    /**
+     * @brief 复制地址空间，私有的页以只读方式共享，写入时再复制
+     * @param  _src            要复制的地址空间，不能是内核地址空间
+     * @return ADDRESS_SPACE*  新的地址空间，由调用者 delete
+     * @note 只复制区域与页表项，代价与已映射的页数相关，与页的内容无关
+     */
+    static ADDRESS_SPACE *clone_address_space(ADDRESS_SPACE &_src);
+
+    /**
+     * @brief 获取共享的零页
+     * @return uintptr_t       零页的物理地址
+     */
+    static uintptr_t get_zero_page(void);
+
+    /**
+     * @brief 获取物理页被多少个地址空间映射
+     * @param  _pa             物理页
+     * @return size_t          使用者数量
+     */
+    static size_t get_page_ref(uintptr_t _pa);
+
+    /// 空闲时每次扫描的页数
+    static constexpr const size_t AGE_BATCH = 64;
+    /// 空闲时每次合并扫描的页数
+    static constexpr const size_t MERGE_BATCH = 64;
+
+    /**
+     * @brief 扫描 LRU 链表，根据已使用位在两个链表间移动页
+     * @param  _count          每个链表最多扫描的页数
+     * @return size_t          移到非活跃链表的页数
+     * @note 被访问过的非活跃页移到活跃链表，没有被访问过的活跃页移到
+     * 非活跃链表，检查后清除已使用位。由空闲循环定期调用
+     */
+    static size_t age_pages(size_t _count);
+
+    /**
+     * @brief 从非活跃链表表头开始回收页
+     * @param  _count          要回收的页数
+     * @return size_t          实际回收的页数
+     * @note 扫描时被访问过的页移到活跃链表，不会被回收
+     */
+    static size_t reclaim_pages(size_t _count);
+
+    /**
+     * @brief 在所有地址空间中查找可以合并的大页范围并合并
+     * @return size_t          合并的大页数
+     * @note 由空闲循环定期调用
+     */
+    static size_t promote_huge(void);
+
+    /**
+     * @brief 开启或关闭相同页合并
+     * @param  _enable         是否开启
+     * @note 默认关闭，关闭时丢弃所有记录，已合并的页保持共享
+     */
+    static void set_merge(bool _enable);
+
+    /**
+     * @brief 继续上次的位置扫描匿名页，合并内容相同的页
+     * @param  _count          最多扫描的页数
+     * @return size_t          合并的页数
+     * @note 由空闲循环定期调用，先以哈希查找，再逐字节比较确认
+     * 全为 0 的页直接使用零页
+     */
+    static size_t merge_pages(size_t _count);
+
+    /**
+     * @brief 获取相同页合并的统计信息
+     * @return const merge_stat_t&  统计信息
+     */
+    static const merge_stat_t &get_merge_stat(void);
+
+    /**
+     * @brief 获取 LRU 链表中的页数
+     * @param  _active         是否为活跃链表
+     * @return size_t          页数
+     */
+    static size_t get_lru_count(bool _active);
+
+    /**
+     * @brief 获取工作集的估计，即最近的扫描中被访问过的页数
+     * @return size_t          页数
+     */
+    size_t get_working_set(void) const;
+
+    /**
+     * @brief 获取缺页分配并仍然映射着的页数，大页按 4KB 计算
+     * @return size_t          页数
+     */
+    size_t get_resident(void) const;
+
+    /**
+     * @brief 获取回收时压缩保存的页数
+     * @return size_t          页数
+     */
+    size_t get_swapped(void) const;
+
+    /**
+     * @brief 获取硬件支持的 ASID 数量
+     * @return size_t          数量
+     */
+    static size_t get_asid_count(void);
+
+    /**
+     * @brief 切换到这个地址空间
+     * @note ASID 仍属于当前代时不刷新缓存
+     */
+    void switch_to(void);
+
+    /**
+     * @brief 获取页目录
+     * @return pt_t            页目录
+     */
+    pt_t get_pgd(void) const;
+
+    /**
+     * @brief 映射一段物理地址到虚拟地址
+     * @param  _va             要映射的虚拟地址，按页对齐
+     * @param  _pa             物理地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @param  _flag           属性
+     * @note 地址空间不在使用时，下次切换会使用新的 ASID
+     */
+    void mmap(uintptr_t _va, uintptr_t _pa, size_t _len, uint32_t _flag);
+
+    /**
+     * @brief 取消一段虚拟地址的映射
+     * @param  _va             要取消映射的虚拟地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @note 只有一部分在范围内的大页先被拆分
+     */
+    void unmmap(uintptr_t _va, size_t _len);
+
+    /**
+     * @brief 获取映射的物理地址
+     * @param  _va             虚拟地址
+     * @param  _pa             如果已经映射，保存映射的物理地址，否则为 nullptr
+     * @return true            已映射
+     * @return false           未映射
+     */
+    bool get_mmap(uintptr_t _va, const void *_pa);
+
+    /**
+     * @brief 添加匿名内存区域
+     * @param  _start          起始地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @param  _flag           映射属性
+     * @return true            成功
+     * @return false           与已有的区域重叠，或属性无效
+     */
+    bool add_vma(uintptr_t _start, size_t _len, uint32_t _flag);
+
+    /**
+     * @brief 添加物理内存区域
+     * @param  _start          起始地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @param  _pa             起始地址对应的物理地址，按页对齐
+     * @param  _flag           映射属性
+     * @return true            成功
+     * @return false           与已有的区域重叠，或属性无效
+     */
+    bool add_vma_phys(uintptr_t _start, size_t _len, uintptr_t _pa,
+                      uint32_t _flag);
+
+    /**
+     * @brief 添加由 _fill 填充的区域
+     * @param  _start          起始地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @param  _flag           映射属性
+     * @param  _fill           填充函数
+     * @param  _data           填充函数的参数
+     * @return true            成功
+     * @return false           与已有的区域重叠，或属性无效
+     */
+    bool add_vma_file(uintptr_t _start, size_t _len, uint32_t _flag,
+                      vma_fill_t _fill, void *_data);
+
+    /**
+     * @brief 修改一段地址的映射属性
+     * @param  _start          起始地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @param  _flag           新的属性
+     * @return true            成功
+     * @return false           范围不在同一个区域中，或属性无效
+     * @note 只覆盖区域的一部分时拆分区域，跨过边界的大页被拆分
+     * 共享的页与零页保持只读，写入时复制
+     */
+    bool protect_vma(uintptr_t _start, size_t _len, uint32_t _flag);
+
+    /**
+     * @brief 删除虚拟内存区域
+     * @param  _start          区域的起始地址
+     * @return true            成功
+     * @return false           没有这个区域
+     * @note 会取消区域中的映射，并释放分配的页
+     */
+    bool del_vma(uintptr_t _start);
+
+    /**
+     * @brief 查找 _va 所在的虚拟内存区域
+     * @param  _va             虚拟地址
+     * @return const vma_t*    所在的区域，不存在返回 nullptr
+     */
+    const vma_t *find_vma(uintptr_t _va) const;
+
+    /**
+     * @brief 处理这个地址空间中的缺页
+     * @param  _va             访问的地址
+     * @param  _write          是否为写访问
+     * @return true            已经映射，可以重新执行访问
+     * @return false           地址不属于任何区域或权限不足
+     * @note 写入共享的只读页时进行写时复制
+     */
+    bool handle_fault(uintptr_t _va, bool _write);
+
+    /**
+     * @brief 处理当前地址空间中的缺页，由各架构的缺页异常调用
+     * @param  _va             访问的地址
+     * @param  _write          是否为写访问
+     * @return true            已经映射，可以重新执行访问
+     * @return false           无法处理
+     */
+    static bool page_fault(uintptr_t _va, bool _write);
+};
+
+#endif /* _ADDRESS_SPACE_H_ */
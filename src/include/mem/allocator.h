@@ -64,6 +64,15 @@ public:
      */
     virtual bool alloc(uintptr_t _addr, size_t _len) = 0;
 
+    /**
+     * @brief 分配 _len 个不要求连续的单位
+     * @param  _addrs          保存分配到的地址
+     * @param  _len            数量
+     * @return size_t          分配到的数量，不足时已分配的不会释放
+     * @note 默认逐个分配，子类可以一次完成
+     */
+    virtual size_t alloc_bulk(uintptr_t *_addrs, size_t _len);
+
     /**
      * @brief 释放 _len 长度
      * @param  _addr           地址
@@ -0,0 +1,69 @@
+
+/**
+ * @file allocator_resource.h
+ * @brief 分配器内存资源头文件
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#ifndef _ALLOCATOR_RESOURCE_H_
+#define _ALLOCATOR_RESOURCE_H_
+
+#include "stddef.h"
+#include "stdint.h"
+#include "memory_resource"
+#include "allocator.h"
+
+/**
+ * @brief 将内核的 ALLOCATOR 包装为 mystl::pmr::memory_resource
+ * 使 pmr 容器可以直接从 SLAB、FIRSTFIT 等分配器上分配
+ * @note ALLOCATOR 的长度单位以具体实现为准，
+ * SLAB 以 byte 为单位，FIRSTFIT 以页为单位，构造时需给出单位大小
+ */
+class ALLOCATOR_RESOURCE : public mystl::pmr::memory_resource {
+private:
+    /// 被包装的分配器
+    ALLOCATOR *allocator;
+    /// 分配器一个长度单位对应的 bytes
+    size_t unit;
+    /// 分配器返回地址的对齐保证
+    size_t align;
+    /// 可用地址相对分配器地址的偏移，如物理页分配器使用直接映射区时
+    uintptr_t offset;
+
+    /**
+     * @brief 将 bytes 换算为分配器的长度单位
+     * @param  _bytes          bytes
+     * @return size_t          长度
+     */
+    size_t to_units(size_t _bytes) const;
+
+    void *do_allocate(size_t _bytes, size_t _align) override;
+    void  do_deallocate(void *_p, size_t _bytes, size_t _align) override;
+    bool  do_is_equal(const mystl::pmr::memory_resource &_other) const
+        noexcept override;
+
+protected:
+public:
+    /**
+     * @brief 构造分配器资源
+     * @param  _allocator      要包装的分配器
+     * @param  _unit           分配器一个长度单位对应的 bytes
+     * @param  _align          分配器返回地址的对齐保证
+     * @param  _offset         可用地址相对分配器地址的偏移
+     */
+    ALLOCATOR_RESOURCE(ALLOCATOR *_allocator, size_t _unit, size_t _align,
+                       uintptr_t _offset);
+
+    ~ALLOCATOR_RESOURCE(void) override;
+};
+
+#endif /* _ALLOCATOR_RESOURCE_H_ */
@@ -103,6 +103,14 @@ public:
      */
     bool alloc(uintptr_t _addr, size_t _len) override;
 
+    /**
+     * @brief 分配 _len 个不要求连续的页，只遍历一次位图
+     * @param  _addrs          保存分配到的地址
+     * @param  _len            页数
+     * @return size_t          分配到的页数
+     */
+    size_t alloc_bulk(uintptr_t *_addrs, size_t _len) override;
+
     /**
      * @brief 释放 _addr 处 _len 页的内存
      * @param  _addr           要释放内存起点地址
@@ -21,6 +21,7 @@
 #include "stddef.h"
 #include "slab.h"
 #include "allocator.h"
+#include "allocator_resource.h"
 
 /**
  * @brief 堆抽象
@@ -57,6 +58,20 @@ public:
      * @param  _p              要释放的内存地址
      */
     void free(void *_p);
+
+    /**
+     * @brief 已知长度的内存释放
+     * @param  _p              要释放的内存地址
+     * @param  _byte           申请时的 bytes
+     * @note 分配器可以直接根据 _byte 计算所属的 cache，不用读取 chunk 记录
+     */
+    void free_sized(void *_p, size_t _byte);
+
+    /**
+     * @brief 获取堆分配器的内存资源，供 pmr 容器使用
+     * @return mystl::pmr::memory_resource*  内存资源
+     */
+    mystl::pmr::memory_resource *get_resource(void);
 };
 
 #endif /* _HEAP_H_ */
@@ -21,6 +21,7 @@
 #include "stdint.h"
 #include "firstfit.h"
 #include "allocator.h"
+#include "allocator_resource.h"
 
 /**
  * @brief 物理内存管理接口
@@ -76,6 +77,12 @@ public:
      */
     bool init(void);
 
+    /**
+     * @brief 获取物理内存起始地址
+     * @return uintptr_t       物理内存起始地址
+     */
+    uintptr_t get_pmm_start(void) const;
+
     /**
      * @brief 获取物理内存长度
      * @return size_t          物理内存长度
@@ -128,6 +135,24 @@ public:
      */
     bool alloc_pages(uintptr_t _addr, size_t _len);
 
+    /**
+     * @brief 分配起始地址按 _align 对齐的 _len 页
+     * @param  _len            页数
+     * @param  _align          对齐，单位为 bytes，2 的幂
+     * @return uintptr_t       分配的内存起始地址，失败返回 0
+     * @note 用于大页等需要对齐的物理块
+     */
+    uintptr_t alloc_pages_aligned(size_t _len, size_t _align);
+
+    /**
+     * @brief 分配 _len 个不要求连续的页
+     * @param  _pages          保存分配到的页
+     * @param  _len            页数
+     * @return true            成功
+     * @return false           页数不足，不会分配任何页
+     */
+    bool alloc_pages_bulk(uintptr_t *_pages, size_t _len);
+
     /**
      * @brief 在内核空间申请一页
      * @return uintptr_t       分配的内存起始地址
@@ -162,6 +187,14 @@ public:
      * @param  _len            页数
      */
     void free_pages(uintptr_t _addr, size_t _len);
+
+    /**
+     * @brief 获取非内核空间分配器的内存资源，供 pmr 资源作为上游使用
+     * @return mystl::pmr::memory_resource*  内存资源
+     * @note 以页为单位分配，适合作为 monotonic/pool 资源的上游
+     * 返回直接映射区中的地址
+     */
+    mystl::pmr::memory_resource *get_resource(void);
 };
 
 #endif /* _PMM_H_ */
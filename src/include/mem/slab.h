@@ -233,9 +233,10 @@ public:
     /**
      * @brief 释放内存
      * @param  _addr           要释放的地址
-     * @note slab 不使用第二个参数
+     * @param  _len            申请时的长度，以 byte 为单位
+     * @note _len 为 0 时从 chunk 中读取长度
      */
-    void free(uintptr_t _addr, size_t) override;
+    void free(uintptr_t _addr, size_t _len) override;
 
     // 暂时不支持
     size_t get_used_count(void) const override;
@@ -0,0 +1,119 @@
+/**
+ * @file vmalloc.h
+ * @brief 虚拟连续内存分配头文件
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#ifndef _VMALLOC_H_
+#define _VMALLOC_H_
+
+#include "stddef.h"
+#include "stdint.h"
+#include "map"
+#include "common.h"
+#include "allocator.h"
+#include "vmm.h"
+
+#if defined(__i386__)
+/// vmalloc 区域起始地址
+static constexpr const uintptr_t VMALLOC_START = 0xF0000000;
+#elif defined(__x86_64__)
+/// vmalloc 区域起始地址，位于直接映射区之后
+static constexpr const uintptr_t VMALLOC_START = 0xFFFFC90000000000;
+#elif defined(__riscv)
+/// vmalloc 区域起始地址，位于直接映射区之后
+static constexpr const uintptr_t VMALLOC_START = 0xFFFFFFD000000000;
+#endif
+
+/// vmalloc 区域大小，FIRSTFIT 最多管理 128MB
+static constexpr const size_t VMALLOC_SIZE = 128 * COMMON::MB;
+
+/**
+ * @brief 虚拟连续内存分配
+ * 在内核的 vmalloc 区域中分配连续的虚拟地址，由任意不连续的物理页映射
+ * 物理内存碎片化时，大的内核缓冲区与栈仍然可以分配
+ * @note vmalloc 区域位于内核高半部分，页表由所有页目录共享，
+ * 映射的修改对所有地址空间可见
+ */
+class VMALLOC {
+private:
+    /// 已分配的区域
+    struct area_t {
+        /// 页数，不包括之后的保护页
+        size_t pages;
+        /// 物理页是否由 vmalloc 分配，释放时需要归还
+        bool owned;
+    };
+
+    /// 虚拟地址分配器，以页为单位
+    ALLOCATOR *allocator;
+    /// 内核页目录
+    pt_t pgd;
+    /// 已分配的区域，以起始地址为键
+    mystl::map<uintptr_t, area_t> areas;
+
+    /**
+     * @brief 分配 _pages 页虚拟地址，之后保留一页不映射的保护页
+     * @param  _pages          页数
+     * @return uintptr_t       起始地址，失败返回 0
+     */
+    uintptr_t alloc_area(size_t _pages);
+
+    /**
+     * @brief 释放区域中 vmalloc 分配的物理页
+     * @param  _va             起始地址
+     * @param  _pages          页数
+     */
+    void free_frames(uintptr_t _va, size_t _pages);
+
+protected:
+public:
+    /**
+     * @brief 获取单例
+     * @return VMALLOC&        静态对象
+     * @note 需要在堆初始化后调用
+     */
+    static VMALLOC &get_instance(void);
+
+    /**
+     * @brief 初始化
+     * @return true            成功
+     * @return false           失败
+     */
+    bool init(void);
+
+    /**
+     * @brief 分配虚拟地址连续的内存
+     * @param  _len            长度，单位为 bytes
+     * @return void*           分配到的地址，按页对齐，失败返回 nullptr
+     * @note 物理页一次批量分配，不要求连续
+     */
+    void *vmalloc(size_t _len);
+
+    /**
+     * @brief 将若干物理页映射到连续的虚拟地址
+     * @param  _pages          物理页
+     * @param  _count          页数
+     * @param  _flag           属性
+     * @return void*           映射到的地址，失败返回 nullptr
+     * @note 物理页仍属于调用者，vfree 时不会释放
+     */
+    void *vmap(const uintptr_t *_pages, size_t _count, uint32_t _flag);
+
+    /**
+     * @brief 释放 vmalloc/vmap 得到的地址
+     * @param  _addr           vmalloc/vmap 返回的地址
+     */
+    void vfree(void *_addr);
+};
+
+#endif /* _VMALLOC_H_ */
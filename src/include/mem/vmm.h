@@ -27,6 +27,14 @@ typedef uintptr_t pte_t;
 /// 页表，也可以是页目录，它们的结构是一样的
 typedef uintptr_t *pt_t;
 
+/// 物理地址连续的一段内存，用于设置 DMA 等需要物理地址的场合
+struct vmm_sg_t {
+    /// 起始物理地址
+    uintptr_t pa;
+    /// 长度，单位为 bytes
+    size_t len;
+};
+
 /// 每个页表能映射多少页 = 页大小/页表项大小: 2^9
 static constexpr const size_t VMM_PAGES_PRE_PAGE_TABLE =
     COMMON::PAGE_SIZE / sizeof(pte_t);
@@ -48,8 +56,20 @@ static constexpr const uint8_t VMM_PAGE_EXECUTABLE = 0;
 /// U/S-- 位 2 是用户 / 超级用户 (User/Supervisor) 标志。
 /// 如果为 1 那么运行在任何特权级上的程序都可以访问该页面。
 static constexpr const uint8_t VMM_PAGE_USER = 1 << 2;
-/// 内核虚拟地址相对物理地址的偏移
-static constexpr const size_t KERNEL_OFFSET = 0x0;
+/// G 位，需要 CR4.PGE，全局页的 TLB 项在写入 CR3 时不会被刷新
+static constexpr const uint16_t VMM_PAGE_GLOBAL = 1 << 8;
+/// A 位，访问时由 CPU 置位，用于替换算法
+static constexpr const uint8_t VMM_PAGE_ACCESSED = 1 << 5;
+/// D 位，写入时由 CPU 置位，用于替换算法
+static constexpr const uint8_t VMM_PAGE_DIRTY = 1 << 6;
+/// 指向下一级页表的页表项的属性，各级权限取交集，由叶子决定实际的权限
+static constexpr const uint8_t VMM_PAGE_TABLE =
+    VMM_PAGE_VALID | VMM_PAGE_WRITABLE | VMM_PAGE_USER;
+/// 直接映射区相对物理地址的偏移，内核链接在这里
+/// 32 位地址空间不足，直接映射区只有 vmalloc 区之前的 768MB
+static constexpr const size_t KERNEL_OFFSET = 0xC0000000;
+/// 内核独占的高地址部分起始地址，最高的 1GB
+static constexpr const uintptr_t VMM_KERNEL_HALF_START = KERNEL_OFFSET;
 /// PTE 属性位数
 static constexpr const size_t VMM_PTE_PROP_BITS = 12;
 /// PTE 页内偏移位数
@@ -60,6 +80,10 @@ static constexpr const size_t VMM_VPN_BITS = 10;
 static constexpr const size_t VMM_VPN_BITS_MASK = 0x3FF;
 /// i386 使用了两级页表
 static constexpr const size_t VMM_PT_LEVEL = 2;
+/// PS 位，非最低级页表项置位时为大页，需要 CR4.PSE，暂不使用
+static constexpr const uint8_t VMM_PAGE_HUGE = 1 << 7;
+/// 允许作为叶子的最高级页表，0 表示只使用 4KB 页
+static constexpr const size_t VMM_HUGE_LEVEL = 0;
 
 #elif defined(__x86_64__)
 /// P = 1 表示有效； P = 0 表示无效。
@@ -71,8 +95,19 @@ static constexpr const uint8_t VMM_PAGE_EXECUTABLE = 0;
 /// U/S-- 位 2 是用户 / 超级用户 (User/Supervisor) 标志。
 /// 如果为 1 那么运行在任何特权级上的程序都可以访问该页面。
 static constexpr const uint8_t VMM_PAGE_USER = 1 << 2;
-/// 内核虚拟地址相对物理地址的偏移
-static constexpr const size_t KERNEL_OFFSET = 0x0;
+/// G 位，需要 CR4.PGE，全局页的 TLB 项在写入 CR3 时不会被刷新
+static constexpr const uint16_t VMM_PAGE_GLOBAL = 1 << 8;
+/// A 位，访问时由 CPU 置位，用于替换算法
+static constexpr const uint8_t VMM_PAGE_ACCESSED = 1 << 5;
+/// D 位，写入时由 CPU 置位，用于替换算法
+static constexpr const uint8_t VMM_PAGE_DIRTY = 1 << 6;
+/// 指向下一级页表的页表项的属性，各级权限取交集，由叶子决定实际的权限
+static constexpr const uint8_t VMM_PAGE_TABLE =
+    VMM_PAGE_VALID | VMM_PAGE_WRITABLE | VMM_PAGE_USER;
+/// 直接映射区相对物理地址的偏移，位于高半部分第一个 PML4 项，内核链接在这里
+static constexpr const size_t KERNEL_OFFSET = 0xFFFF800000000000;
+/// 内核独占的高半部分起始地址
+static constexpr const uintptr_t VMM_KERNEL_HALF_START = KERNEL_OFFSET;
 /// PTE 属性位数
 static constexpr const size_t VMM_PTE_PROP_BITS = 12;
 /// PTE 页内偏移位数
@@ -83,6 +118,10 @@ static constexpr const size_t VMM_VPN_BITS = 9;
 static constexpr const size_t VMM_VPN_BITS_MASK = 0x1FF;
 /// x86_64 使用了四级页表
 static constexpr const size_t VMM_PT_LEVEL = 4;
+/// PS 位，PDE/PDPTE 置位时为 2MB/1GB 大页
+static constexpr const uint8_t VMM_PAGE_HUGE = 1 << 7;
+/// 允许作为叶子的最高级页表，1 级为 2MB，2 级为 1GB(需要 CPU 支持)
+static constexpr const size_t VMM_HUGE_LEVEL = 2;
 
 #elif defined(__riscv)
 /// 有效位
@@ -95,14 +134,18 @@ static constexpr const uint8_t VMM_PAGE_WRITABLE = 1 << 2;
 static constexpr const uint8_t VMM_PAGE_EXECUTABLE = 1 << 3;
 /// 用户位
 static constexpr const uint8_t VMM_PAGE_USER = 1 << 4;
-/// 全局位，我们不会使用
+/// 全局位，存在于所有地址空间，sfence.vma 指定 ASID 时不会被刷新
 static constexpr const uint8_t VMM_PAGE_GLOBAL = 1 << 5;
 /// 已使用位，用于替换算法
 static constexpr const uint8_t VMM_PAGE_ACCESSED = 1 << 6;
 /// 已修改位，用于替换算法
 static constexpr const uint8_t VMM_PAGE_DIRTY = 1 << 7;
-/// 内核虚拟地址相对物理地址的偏移
-static constexpr const size_t KERNEL_OFFSET = 0x0;
+/// 指向下一级页表的页表项的属性，R/W/X 都为 0 的有效项指向下一级页表
+static constexpr const uint8_t VMM_PAGE_TABLE = VMM_PAGE_VALID;
+/// 直接映射区相对物理地址的偏移，sv39 高半部分的起始地址，内核链接在这里
+static constexpr const size_t KERNEL_OFFSET = 0xFFFFFFC000000000;
+/// 内核独占的高半部分起始地址
+static constexpr const uintptr_t VMM_KERNEL_HALF_START = KERNEL_OFFSET;
 /// PTE 属性位数
 static constexpr const size_t VMM_PTE_PROP_BITS = 10;
 /// PTE 页内偏移位数
@@ -113,11 +156,15 @@ static constexpr const size_t VMM_VPN_BITS = 9;
 static constexpr const size_t VMM_VPN_BITS_MASK = 0x1FF;
 /// riscv64 使用了三级页表
 static constexpr const size_t VMM_PT_LEVEL = 3;
+/// sv39 中 R/W/X 任一位不为 0 的页表项即为叶子，不需要额外的标志
+static constexpr const uint8_t VMM_PAGE_HUGE = 0;
+/// 允许作为叶子的最高级页表，1 级为 2MB megapage，2 级为 1GB gigapage
+static constexpr const size_t VMM_HUGE_LEVEL = 2;
 #endif
 
 /**
  * @brief 虚拟地址到物理地址转换
- * @param  _va             要转换的虚拟地址
+ * @param  _va             要转换的虚拟地址，位于直接映射区
  * @return constexpr uintptr_t 转换好的地址
  */
 static constexpr uintptr_t VMM_VA2PA(uintptr_t _va) {
@@ -127,12 +174,31 @@ static constexpr uintptr_t VMM_VA2PA(uintptr_t _va) {
 /**
  * @brief 物理地址到虚拟地址转换
  * @param  _pa             要转换的物理地址
- * @return constexpr uintptr_t 转换好的地址
+ * @return constexpr uintptr_t 直接映射区中的地址，可以直接访问
  */
 static constexpr uintptr_t VMM_PA2VA(uintptr_t _pa) {
     return _pa + KERNEL_OFFSET;
 }
 
+/**
+ * @brief 换出位置到页表项转换
+ * 有效位为 0 且不为 0 的页表项表示换出的页，其余位保存换出的位置
+ * @param  _entry          换出的位置，不为 0
+ * @return constexpr pte_t 页表项
+ */
+static constexpr pte_t VMM_SWAP2PTE(uintptr_t _entry) {
+    return (pte_t)_entry << 1;
+}
+
+/**
+ * @brief 页表项到换出位置转换
+ * @param  _pte            换出的页的页表项
+ * @return constexpr uintptr_t 换出的位置
+ */
+static constexpr uintptr_t VMM_PTE2SWAP(pte_t _pte) {
+    return (uintptr_t)(_pte >> 1);
+}
+
 /**
  * @brief 虚拟内存抽象
  */
@@ -158,6 +224,24 @@ private:
         return (((uintptr_t)_pte) >> VMM_PTE_PROP_BITS) << VMM_PAGE_OFF_BITS;
     }
 
+    /**
+     * @brief 页表项转换到下一级页表
+     * @param  _pte            指向下一级页表的页表项
+     * @return pt_t            页表在直接映射区中的地址
+     */
+    static inline pt_t PTE2PT(const pte_t _pte) {
+        return (pt_t)VMM_PA2VA(PTE2PA(_pte));
+    }
+
+    /**
+     * @brief 页表转换到指向它的页表项
+     * @param  _pt             页表在直接映射区中的地址
+     * @return pte_t           页表项，不含属性
+     */
+    static inline pte_t PT2PTE(const pt_t _pt) {
+        return PA2PTE(VMM_VA2PA((uintptr_t)_pt));
+    }
+
     /**
      * @brief 计算 X 级页表的位置
      * @param  _level          级别
@@ -176,6 +260,149 @@ private:
         return (_va >> PXSHIFT(_level)) & VMM_VPN_BITS_MASK;
     }
 
+    /**
+     * @brief 第 _level 级页表项映射的长度
+     * @param  _level          级别
+     * @return constexpr size_t 长度，0 级为 4KB
+     */
+    static constexpr size_t PXSIZE(const size_t _level) {
+        return (size_t)1 << PXSHIFT(_level);
+    }
+
+    /**
+     * @brief 判断第 _level 级的有效页表项是否为叶子
+     * @param  _pte            页表项
+     * @param  _level          级别
+     * @return true            是叶子，映射了一页(或大页)
+     * @return false           指向下一级页表
+     */
+    static constexpr bool IS_LEAF(const pte_t _pte, const size_t _level) {
+#if defined(__riscv)
+        (void)_level;
+        return (_pte & (VMM_PAGE_READABLE | VMM_PAGE_WRITABLE |
+                        VMM_PAGE_EXECUTABLE)) != 0;
+#else
+        return (_level == 0) || ((_pte & VMM_PAGE_HUGE) != 0);
+#endif
+    }
+
+    /// 当前 CPU 允许作为叶子的最高级页表
+    size_t huge_level;
+
+    /// 超过这个页数时刷新全部缓存，而不是逐页刷新
+    static constexpr const size_t FLUSH_ALL_PAGES = 32;
+
+    /// 上次刷新后是否修改过非叶子页表项
+    /// riscv 的 sfence.vma va 只对叶子有效，此时需要全部刷新
+    bool pt_changed;
+
+    /// 内核页目录
+    pt_t pgd_kernel;
+
+    /// 软件 TLB 项数，2 的幂
+    static constexpr const size_t TLB_ENTRIES = 64;
+
+    /// 软件 TLB 项，缓存 get_mmap 的结果
+    struct tlb_entry_t {
+        /// 所属的页目录，nullptr 表示无效
+        pt_t pgd;
+        /// 虚拟页
+        uintptr_t va;
+        /// 物理页
+        uintptr_t pa;
+    };
+
+    /// 软件 TLB，按虚拟页号直接映射，目前只有一个 CPU
+    tlb_entry_t tlb[TLB_ENTRIES];
+
+    /**
+     * @brief 获取 _va 在软件 TLB 中的项
+     * @param  _va             虚拟地址
+     * @return tlb_entry_t&    _va 所在页对应的项
+     */
+    tlb_entry_t &tlb_entry(uintptr_t _va);
+
+    /**
+     * @brief 使一段虚拟地址在软件 TLB 中的项失效
+     * @param  _va             虚拟地址
+     * @param  _len            长度，单位为 bytes
+     * @note 不区分页目录，共享的页表修改后其它页目录的项也会失效
+     */
+    void tlb_invalidate(uintptr_t _va, size_t _len);
+
+    /**
+     * @brief 使软件 TLB 中的所有项失效
+     */
+    void tlb_invalidate_all(void);
+
+    /// 是否已有其它页目录共享内核页目录的项
+    /// 此后内核页目录直接指向的页表不再释放
+    bool kernel_shared;
+
+    /// 每个页表中不为 0 的页表项的数量，包括换出的页
+    /// 页表都从内核空间分配，以页表所在的内核空间页号为下标
+    uint16_t pt_count[VMM_KERNEL_SPACE_PAGES];
+
+    /**
+     * @brief 获取 _pte 所在页表的不为 0 的页表项数量
+     * @param  _pte            页表项
+     * @return uint16_t&       数量
+     */
+    uint16_t &count(const pte_t *_pte);
+
+    /**
+     * @brief 从内核空间分配一页作为页表并清零
+     * @return pt_t            页表，失败返回 nullptr
+     */
+    pt_t alloc_pt(void);
+
+    /**
+     * @brief 设置页表项，同时维护所在页表的不为 0 的页表项数量
+     * @param  _pte            要设置的页表项
+     * @param  _val            新的值
+     */
+    void set_pte(pte_t *_pte, pte_t _val);
+
+    /**
+     * @brief 从 _va 的第 _level 级页表开始，向上释放空的页表
+     * @param  _pgd            页目录
+     * @param  _va             虚拟地址
+     * @param  _level          第一个要检查的页表级别
+     * @note 页目录本身不会被释放
+     */
+    void reclaim(const pt_t _pgd, uintptr_t _va, size_t _level);
+
+    /**
+     * @brief 为内核高半部分的每个顶级页表项预先分配页表，且不会被回收
+     * 之后的页目录复制这些项即共享了整个内核高半部分，
+     * 内核映射的修改对所有地址空间可见，不需要同步
+     */
+    void reserve_kernel_half(void);
+
+    /**
+     * @brief 刷新全部缓存
+     * @param  _pgd            修改的页目录
+     * @param  _va             修改的虚拟地址
+     * @note 共享的页表需要刷新所有地址空间的缓存
+     */
+    void flush_all(const pt_t _pgd, uintptr_t _va);
+
+    /**
+     * @brief 刷新一段虚拟地址的缓存
+     * @param  _pgd            修改的页目录
+     * @param  _va             虚拟地址
+     * @param  _len            长度，单位为 bytes
+     */
+    void flush_range(const pt_t _pgd, uintptr_t _va, size_t _len);
+
+    /**
+     * @brief 释放第 _level 级页表及其下的所有页表
+     * @param  _pt             页表
+     * @param  _level          级别
+     * @note 叶子映射的物理页不会被释放
+     */
+    void free_pt(pt_t _pt, size_t _level);
+
     /**
      * @brief 在 _pgd 中查找 _va 对应的页表项
      * 如果未找到，_alloc 为真时会进行分配
@@ -186,6 +413,59 @@ private:
      */
     pte_t *find(const pt_t _pgd, uintptr_t _va, bool _alloc);
 
+    /**
+     * @brief 在 _pgd 中查找 _va 对应的第 _level 级页表项
+     * 如果未找到，_alloc 为真时会进行分配
+     * 途中遇到大页时，_alloc 为真则将其拆分，否则直接返回大页的页表项
+     * @param  _pgd            要查找的页目录
+     * @param  _va             虚拟地址
+     * @param  _alloc          是否分配
+     * @param  _level          要查找的级别，返回时为页表项实际所在的级别
+     * @return pte_t*          未找到返回 nullptr
+     */
+    pte_t *find(const pt_t _pgd, uintptr_t _va, bool _alloc, size_t &_level);
+
+    /// 顺序访问最低级页表项的迭代器，记录当前所在的页表
+    struct walker_t {
+        /// 页目录
+        pt_t pgd;
+        /// 是否分配不存在的页表，此时途中的大页会被拆分
+        bool alloc;
+        /// 当前的最低级页表，nullptr 表示需要从页目录重新查找
+        pt_t pt;
+        /// 当前页表映射范围的起始地址
+        uintptr_t base;
+    };
+
+    /**
+     * @brief 获取 _va 的最低级页表项
+     * _va 与上次在同一个页表中时直接返回，否则从页目录查找并记录
+     * @param  _walker         迭代器
+     * @param  _va             虚拟地址
+     * @return pte_t*          页表项，页表不存在或 _va 位于大页中时返回 nullptr
+     * @note 修改了上级页表项(映射大页、释放页表)后需要将 pt 置为 nullptr
+     */
+    pte_t *walk(walker_t &_walker, uintptr_t _va);
+
+    /**
+     * @brief 将第 _level 级的大页拆分为下一级的页表
+     * @param  _pte            大页的页表项
+     * @param  _level          大页所在的级别
+     * @param  _va             大页中的任一虚拟地址，用于刷新缓存
+     */
+    void split(pte_t *_pte, size_t _level, uintptr_t _va);
+
+    /**
+     * @brief 查找 [_va, _end) 中第一个已映射的页，跳过不存在的页表
+     * @param  _pgd            页目录
+     * @param  _va             起始地址，返回时为找到的页的地址
+     * @param  _end            结束地址(不含)
+     * @param  _level          返回页表项所在的级别
+     * @return pte_t*          页表项，没有已映射的页返回 nullptr
+     */
+    pte_t *next_pte(const pt_t _pgd, uintptr_t &_va, uintptr_t _end,
+                    size_t &_level);
+
 protected:
 public:
     /**
@@ -213,6 +493,30 @@ public:
      */
     void set_pgd(const pt_t _pgd);
 
+    /**
+     * @brief 分配新的页目录，与内核页目录共享内核的映射
+     * @return pt_t            新的页目录，失败返回 nullptr
+     * @note 高半部分的顶级页表项都已预先分配，之后的内核映射对新的页目录可见
+     * 内核只在高半部分运行，低地址全部留给新的地址空间
+     */
+    pt_t alloc_pgd(void);
+
+    /**
+     * @brief 判断 _pgd 中 _va 所在的页表是否与内核页目录共享
+     * @param  _pgd            页目录
+     * @param  _va             虚拟地址
+     * @return true            共享，可能被其它地址空间缓存
+     * @return false           不共享
+     */
+    bool shared(const pt_t _pgd, uintptr_t _va);
+
+    /**
+     * @brief 释放 alloc_pgd 分配的页目录与其独有的页表
+     * @param  _pgd            要释放的页目录，不能是正在使用的页目录
+     * @note 叶子映射的物理页不会被释放
+     */
+    void free_pgd(pt_t _pgd);
+
     /**
      * @brief 映射物理地址到虚拟地址
      * @param  _pgd            要使用的页目录
@@ -222,6 +526,31 @@ public:
      */
     void mmap(const pt_t _pgd, uintptr_t _va, uintptr_t _pa, uint32_t _flag);
 
+    /**
+     * @brief 将若干不连续的物理页映射到连续的虚拟地址
+     * @param  _pgd            要使用的页目录
+     * @param  _va             要映射的虚拟地址，按页对齐
+     * @param  _pages          物理页
+     * @param  _count          页数
+     * @param  _flag           属性
+     * @note 同一个页表中的页只查找一次，结束时统一刷新缓存
+     */
+    void mmap_pages(const pt_t _pgd, uintptr_t _va, const uintptr_t *_pages,
+                    size_t _count, uint32_t _flag);
+
+    /**
+     * @brief 映射一段物理地址到虚拟地址
+     * @param  _pgd            要使用的页目录
+     * @param  _va             要映射的虚拟地址，按页对齐
+     * @param  _pa             物理地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @param  _flag           属性
+     * @note _va、_pa 与剩余长度都按大页对齐时使用大页映射
+     * 连续的页表项共用一次查找，结束时统一刷新缓存
+     */
+    void mmap_range(const pt_t _pgd, uintptr_t _va, uintptr_t _pa, size_t _len,
+                    uint32_t _flag);
+
     /**
      * @brief 取消映射
      * @param  _pgd            要操作的页目录
@@ -229,6 +558,15 @@ public:
      */
     void unmmap(const pt_t _pgd, uintptr_t _va);
 
+    /**
+     * @brief 取消一段虚拟地址的映射
+     * @param  _pgd            要操作的页目录
+     * @param  _va             要取消映射的虚拟地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @note 连续的页表项共用一次查找，结束时统一刷新缓存
+     */
+    void unmmap_range(const pt_t _pgd, uintptr_t _va, size_t _len);
+
     /**
      * @brief 获取映射的物理地址
      * @param  _pgd            页目录
@@ -236,8 +574,129 @@ public:
      * @param  _pa             如果已经映射，保存映射的物理地址，否则为 nullptr
      * @return true            已映射
      * @return false           未映射
+     * @note 结果缓存在软件 TLB 中，命中时不需要查找页表
      */
     bool get_mmap(const pt_t _pgd, uintptr_t _va, const void *_pa);
+
+    /**
+     * @brief 将一段虚拟地址转换为物理地址连续的若干段
+     * @param  _pgd            页目录
+     * @param  _va             虚拟地址，不需要对齐
+     * @param  _len            长度，单位为 bytes
+     * @param  _sg             保存结果
+     * @param  _count          _sg 的项数
+     * @return size_t          使用的项数，有未映射的地址或项数不足时返回 0
+     * @note 同一个页表中的页只查找一次，物理地址连续的页合并为一段
+     */
+    size_t get_mmap_sg(const pt_t _pgd, uintptr_t _va, size_t _len,
+                       vmm_sg_t *_sg, size_t _count);
+
+    /**
+     * @brief 查找 [_va, _end) 中第一个已映射的页
+     * @param  _pgd            页目录
+     * @param  _va             起始地址，按页对齐，返回时为找到的页的地址
+     * @param  _end            结束地址(不含)
+     * @param  _pa             保存找到的页的物理地址
+     * @return true            找到
+     * @return false           范围内没有已映射的页
+     * @note 不存在的页表整个跳过，遍历的代价与已映射的页数相关
+     */
+    bool next_mmap(const pt_t _pgd, uintptr_t &_va, uintptr_t _end,
+                   const void *_pa);
+
+    /**
+     * @brief 修改一段虚拟地址中已有映射的属性，未映射的地址保持不变
+     * @param  _pgd            要操作的页目录
+     * @param  _va             虚拟地址，按页对齐
+     * @param  _len            长度，单位为 bytes，按页对齐
+     * @param  _flag           新的属性
+     * @note 只有一部分在范围内的大页会被拆分，结束时统一刷新缓存
+     * 已使用位与已修改位保持不变
+     */
+    void protect_range(const pt_t _pgd, uintptr_t _va, size_t _len,
+                       uint32_t _flag);
+
+    /**
+     * @brief 检查并清除 _va 所在页的已使用位
+     * @param  _pgd            要操作的页目录
+     * @param  _va             虚拟地址
+     * @return true            上次清除后被访问过
+     * @return false           没有被访问过，或没有映射
+     * @note 被访问过时刷新当前 ASID 中这一页的缓存，之后的访问会重新置位
+     * 没有被访问过的页不会被缓存，不需要刷新
+     * 其它 ASID 中缓存的项不刷新，访问不会重新置位，只会让页显得更冷
+     */
+    bool test_and_clear_accessed(const pt_t _pgd, uintptr_t _va);
+
+    /**
+     * @brief 检查 _va 所在页的已修改位
+     * @param  _pgd            要操作的页目录
+     * @param  _va             虚拟地址
+     * @return true            映射后被写入过
+     * @return false           没有被写入过，或没有映射
+     */
+    bool is_dirty(const pt_t _pgd, uintptr_t _va);
+
+    /**
+     * @brief 将已映射的页替换为换出的页表项
+     * @param  _pgd            要操作的页目录
+     * @param  _va             虚拟地址
+     * @param  _entry          换出的位置，不为 0
+     * @note 页表项的有效位为 0，访问时缺页，重新映射时直接覆盖
+     */
+    void set_swap(const pt_t _pgd, uintptr_t _va, uintptr_t _entry);
+
+    /**
+     * @brief 获取 _va 换出的位置
+     * @param  _pgd            要操作的页目录
+     * @param  _va             虚拟地址
+     * @param  _entry          保存换出的位置
+     * @return true            _va 所在页已换出
+     * @return false           已映射或没有映射
+     */
+    bool get_swap(const pt_t _pgd, uintptr_t _va, uintptr_t *_entry);
+
+    /**
+     * @brief 查找 [_va, _end) 中第一个换出的页
+     * @param  _pgd            页目录
+     * @param  _va             起始地址，按页对齐，返回时为找到的页的地址
+     * @param  _end            结束地址(不含)
+     * @param  _entry          保存换出的位置
+     * @return true            找到
+     * @return false           范围内没有换出的页
+     * @note 不存在的页表与大页整个跳过
+     */
+    bool next_swap(const pt_t _pgd, uintptr_t &_va, uintptr_t _end,
+                   uintptr_t *_entry);
+
+    /**
+     * @brief 获取第 1 级大页的大小
+     * @return size_t          大小，单位为 bytes，不支持大页时为 0
+     */
+    size_t get_huge_size(void) const;
+
+    /**
+     * @brief 将 _va 开始的第 1 级大页范围合并为一个大页映射
+     * @param  _pgd            要操作的页目录
+     * @param  _va             虚拟地址，按大页对齐
+     * @param  _pa             物理地址，按大页对齐
+     * @param  _flag           属性
+     * @return true            成功
+     * @return false           不支持大页
+     * @note 原来的最低级页表被释放，其中映射的物理页由调用者处理
+     */
+    bool collapse_huge(const pt_t _pgd, uintptr_t _va, uintptr_t _pa,
+                       uint32_t _flag);
+
+    /**
+     * @brief 如果 _va 位于大页中，将其拆分为 4KB 页
+     * @param  _pgd            要操作的页目录
+     * @param  _va             虚拟地址
+     * @return true            拆分了大页
+     * @return false           没有映射或不是大页
+     * @note 拆分后映射的物理地址与属性不变
+     */
+    bool split_huge(const pt_t _pgd, uintptr_t _va);
 };
 
 #endif /* _VMM_H */
@@ -0,0 +1,224 @@
+/**
+ * @file zram.h
+ * @brief 压缩页存储头文件
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#ifndef _ZRAM_H_
+#define _ZRAM_H_
+
+#include "stddef.h"
+#include "stdint.h"
+#include "map"
+#include "set"
+#include "common.h"
+
+/**
+ * @brief 内存中的压缩页存储
+ * 没有交换设备时，回收的页以 LZ4 块格式压缩后保存在内存中，缺页时解压
+ * 压缩数据按大小分类，每一类从物理页中划分出相同大小的槽
+ * @note 保存的位置由所在的物理页与槽号组成，不为 0，可以编码在页表项中
+ */
+class ZRAM {
+private:
+    /// 槽大小的粒度
+    static constexpr const size_t SLOT_ALIGN = 32;
+    /// 压缩后超过这个长度的页不保存，节省的内存不足
+    static constexpr const size_t MAX_LEN = COMMON::PAGE_SIZE * 3 / 4;
+
+    /// 槽的头部
+    struct slot_t {
+        /// 使用中为压缩数据的长度，空闲时为下一个空闲槽的槽号
+        uint16_t len;
+        /// 引用计数，0 表示空闲
+        uint16_t refs;
+    };
+
+    /// 最大的槽
+    static constexpr const size_t MAX_SLOT =
+        (MAX_LEN + sizeof(slot_t) + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+    /// 大小类的数量，第 i 类的槽大小为 (i + 1) * SLOT_ALIGN
+    static constexpr const size_t CLASSES = MAX_SLOT / SLOT_ALIGN;
+    /// 空闲链表结尾
+    static constexpr const uint16_t FREE_END = 0xFFFF;
+
+    /// 划分为槽的物理页
+    struct zpage_t {
+        /// 槽大小
+        size_t size;
+        /// 使用中的槽数
+        size_t used;
+        /// 第一个空闲槽
+        uint16_t free;
+    };
+
+    /// LZ4 最后至少有这么多字节是字面量
+    static constexpr const size_t LZ4_LAST_LITERALS = 5;
+    /// LZ4 最后一个匹配距离结尾至少这么多字节
+    static constexpr const size_t LZ4_MFLIMIT = 12;
+    /// LZ4 最短匹配长度
+    static constexpr const size_t LZ4_MIN_MATCH = 4;
+    /// 哈希表位数
+    static constexpr const size_t LZ4_HASH_BITS = 12;
+
+    /// 划分为槽的物理页，以物理地址为键
+    mystl::map<uintptr_t, zpage_t> zpages;
+    /// 每个大小类中还有空闲槽的页
+    mystl::set<uintptr_t> partial[CLASSES];
+    /// 保存的页数
+    size_t stored;
+    /// 压缩数据的总长度
+    size_t compressed;
+    /// 因为无法压缩而拒绝的页数
+    size_t rejected;
+    /// 压缩时查找匹配的哈希表，保存位置 + 1，0 表示空
+    uint16_t hash_table[1 << LZ4_HASH_BITS];
+    /// 压缩缓冲区
+    uint8_t buf[MAX_LEN];
+
+    ZRAM(void);
+
+    /**
+     * @brief 写入超过 15 的长度，每 255 一个字节
+     * @param  _dst            输出缓冲区
+     * @param  _out            写入位置，返回时为之后的位置
+     * @param  _n              长度减去 15
+     */
+    static void lz4_write_len(uint8_t *_dst, size_t &_out, size_t _n);
+
+    /**
+     * @brief 读取超过 15 的长度
+     * @param  _src            压缩数据
+     * @param  _len            压缩数据长度
+     * @param  _in             读取位置，返回时为之后的位置
+     * @param  _n              累加读到的长度
+     * @return true            成功
+     * @return false           数据不完整
+     */
+    static bool lz4_read_len(const uint8_t *_src, size_t _len, size_t &_in,
+                             size_t &_n);
+
+    /**
+     * @brief 写入一个序列：字面量与之后的匹配
+     * @param  _dst            输出缓冲区
+     * @param  _cap            输出缓冲区大小
+     * @param  _out            写入位置，返回时为之后的位置
+     * @param  _lit            字面量
+     * @param  _lit_len        字面量长度
+     * @param  _offset         匹配的距离
+     * @param  _match          匹配长度，0 表示最后一个只有字面量的序列
+     * @return true            成功
+     * @return false           输出缓冲区不足
+     */
+    static bool lz4_emit(uint8_t *_dst, size_t _cap, size_t &_out,
+                         const uint8_t *_lit, size_t _lit_len, size_t _offset,
+                         size_t _match);
+
+    /**
+     * @brief 以 LZ4 块格式压缩
+     * @param  _src            原数据
+     * @param  _len            原数据长度
+     * @param  _dst            输出缓冲区
+     * @param  _cap            输出缓冲区大小
+     * @return size_t          压缩后的长度，超过 _cap 时返回 0
+     */
+    size_t lz4_compress(const uint8_t *_src, size_t _len, uint8_t *_dst,
+                        size_t _cap);
+
+    /**
+     * @brief 解压 LZ4 块
+     * @param  _src            压缩数据
+     * @param  _len            压缩数据长度
+     * @param  _dst            输出缓冲区
+     * @param  _cap            原数据长度
+     * @return true            成功
+     * @return false           数据损坏，或解压后的长度不是 _cap
+     */
+    static bool lz4_decompress(const uint8_t *_src, size_t _len,
+                               uint8_t *_dst, size_t _cap);
+
+    /**
+     * @brief 分配一个槽
+     * @param  _size           槽大小，SLOT_ALIGN 的倍数
+     * @return uintptr_t       保存的位置，失败返回 0
+     */
+    uintptr_t alloc_slot(size_t _size);
+
+    /**
+     * @brief 获取位置对应的槽
+     * @param  _entry          保存的位置
+     * @return slot_t*         槽，通过直接映射访问
+     */
+    slot_t *get_slot(uintptr_t _entry);
+
+protected:
+public:
+    /**
+     * @brief 获取单例
+     * @return ZRAM&           静态对象
+     * @note 需要在堆初始化后调用
+     */
+    static ZRAM &get_instance(void);
+
+    /**
+     * @brief 压缩并保存一页
+     * @param  _page           页的内容
+     * @return uintptr_t       保存的位置，无法压缩或内存不足时返回 0
+     * @note 存储空间直接从 PMM 分配，不会触发回收
+     */
+    uintptr_t store(const void *_page);
+
+    /**
+     * @brief 解压保存的页
+     * @param  _entry          store 返回的位置
+     * @param  _page           输出，一页大小
+     */
+    void load(uintptr_t _entry, void *_page);
+
+    /**
+     * @brief 增加一个引用，复制地址空间时共享压缩数据
+     * @param  _entry          保存的位置
+     */
+    void ref(uintptr_t _entry);
+
+    /**
+     * @brief 释放一个引用，没有引用时释放槽，槽全部空闲时归还物理页
+     * @param  _entry          保存的位置
+     */
+    void free(uintptr_t _entry);
+
+    /**
+     * @brief 获取保存的页数
+     * @return size_t          页数
+     */
+    size_t get_stored(void) const;
+
+    /**
+     * @brief 获取存储占用的物理页数
+     * @return size_t          页数
+     */
+    size_t get_pool_pages(void) const;
+
+    /**
+     * @brief 获取压缩数据的总长度
+     * @return size_t          长度，单位为 bytes
+     */
+    size_t get_compressed(void) const;
+
+    /**
+     * @brief 获取因为无法压缩而拒绝的页数
+     * @return size_t          页数
+     */
+    size_t get_rejected(void) const;
+};
+
+#endif /* _ZRAM_H_ */
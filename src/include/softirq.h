@@ -0,0 +1,132 @@
+/**
+ * @file softirq.h
+ * @brief 软中断头文件
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#ifndef _SOFTIRQ_H_
+#define _SOFTIRQ_H_
+
+#include "stddef.h"
+#include "stdint.h"
+
+/**
+ * @brief 小任务，在 TASKLET 软中断中执行
+ */
+struct tasklet_t {
+    /// 执行的函数，可以在其中再次调度自己
+    void (*func)(tasklet_t *_tasklet);
+    /// 私有数据
+    void *data;
+    /// 队列中的下一个
+    tasklet_t *next;
+    /// 是否已经在队列中
+    bool scheduled;
+};
+
+/**
+ * @brief 软中断
+ * 中断处理函数只做必须在禁止中断时完成的工作，其余的由软中断在允许中断时完成
+ * 中断返回前与空闲循环中执行，每次执行有次数限制，剩下的留到下一次
+ * @note 只有一个 CPU，每个 CPU 的软中断就是这个对象
+ */
+class SOFTIRQ {
+public:
+    /// 执行小任务的软中断
+    static constexpr const uint32_t TASKLET = 0;
+    /// 软中断数量
+    static constexpr const uint32_t NR = 8;
+
+    /// 软中断处理函数
+    typedef void (*action_t)(void);
+
+private:
+    /// 一次执行中最多重复的轮数，之后新产生的留到下一次
+    static constexpr const size_t MAX_RESTART = 10;
+    /// 每一轮最多执行的小任务数
+    static constexpr const size_t TASKLET_BUDGET = 16;
+
+    /// 处理函数
+    action_t actions[NR];
+    /// 等待执行的软中断，每一位对应一个
+    volatile uint32_t pending;
+    /// 是否正在执行，中断中不再重复进入
+    bool running;
+    /// 等待执行的小任务
+    tasklet_t *head;
+    tasklet_t *tail;
+
+    /**
+     * @brief TASKLET 软中断，按顺序执行小任务
+     */
+    static void tasklet_action(void);
+
+public:
+    SOFTIRQ(void);
+    ~SOFTIRQ(void);
+
+    /**
+     * @brief 获取单例
+     * @return SOFTIRQ&         静态对象
+     */
+    static SOFTIRQ &get_instance(void);
+
+    /**
+     * @brief 初始化
+     */
+    void init(void);
+
+    /**
+     * @brief 注册软中断处理函数
+     * @param  _nr             软中断号
+     * @param  _action         处理函数，在允许中断时执行
+     */
+    void open(uint32_t _nr, action_t _action);
+
+    /**
+     * @brief 产生软中断
+     * @param  _nr             软中断号
+     * @note 可以在中断中调用
+     */
+    void raise(uint32_t _nr);
+
+    /**
+     * @brief 初始化小任务
+     * @param  _tasklet        小任务
+     * @param  _func           执行的函数
+     * @param  _data           私有数据
+     */
+    static void init_tasklet(tasklet_t *_tasklet, void (*_func)(tasklet_t *),
+                             void *_data);
+
+    /**
+     * @brief 调度小任务，已经在队列中时不重复添加
+     * @param  _tasklet        小任务
+     * @note 可以在中断中调用
+     */
+    void schedule(tasklet_t *_tasklet);
+
+    /**
+     * @brief 执行等待的软中断
+     * @note 中断返回前或空闲循环中调用，执行处理函数时允许中断
+     * 返回时恢复调用前的中断状态
+     */
+    void run(void);
+
+    /**
+     * @brief 获取等待执行的软中断
+     * @return uint32_t        每一位对应一个软中断
+     */
+    uint32_t get_pending(void) const;
+};
+
+#endif /* _SOFTIRQ_H_ */
@@ -0,0 +1,197 @@
+/**
+ * @file timer_wheel.h
+ * @brief 时间轮定时器头文件
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include "stddef.h"
+#include "stdint.h"
+#include "clockevent.h"
+
+/**
+ * @brief 定时器
+ */
+struct timer_list_t {
+    /// 到期时间，单位为 jiffies
+    uint64_t expires;
+    /// 到期时调用，可以在其中重新添加
+    void (*function)(timer_list_t *_timer);
+    /// 私有数据
+    void *data;
+    /// 同一个槽中的下一个定时器
+    timer_list_t *next;
+    /// 指向前一个定时器的 next 或槽，nullptr 表示不在等待
+    timer_list_t **pprev;
+};
+
+/**
+ * @brief 分级时间轮
+ * 精度为 CLOCKEVENT::TICK_NS 的定时器，添加与删除都是 O(1)
+ * 第一级每个槽对应一个 jiffies，之后每一级的槽覆盖前一级的一圈，
+ * 第一级转完一圈时把下一级对应槽中的定时器重新分配到前一级
+ * @note 由一个时钟事件驱动，只在可能有定时器到期时唤醒，空闲时不依赖周期时钟
+ * 需要精确到期时间的定时器直接使用 CLOCKEVENT
+ */
+class TIMER_WHEEL {
+private:
+    /// 第一级的位数
+    static constexpr const size_t TVR_BITS = 8;
+    /// 之后每一级的位数
+    static constexpr const size_t TVN_BITS = 6;
+    /// 第一级的槽数
+    static constexpr const size_t TVR_SIZE = 1 << TVR_BITS;
+    /// 之后每一级的槽数
+    static constexpr const size_t TVN_SIZE = 1 << TVN_BITS;
+    static constexpr const size_t TVR_MASK = TVR_SIZE - 1;
+    static constexpr const size_t TVN_MASK = TVN_SIZE - 1;
+    /// 第一级之后的级数
+    static constexpr const size_t TVN_LEVELS = 4;
+    /// 最远的到期时间，超过的按这个时间保存
+    static constexpr const uint64_t MAX_TIMEOUT =
+        ((uint64_t)1 << (TVR_BITS + TVN_BITS * TVN_LEVELS)) - 1;
+
+    /// 第一级
+    timer_list_t *tv1[TVR_SIZE];
+    /// 之后的各级
+    timer_list_t *tvn[TVN_LEVELS][TVN_SIZE];
+    /// 当前的 jiffies
+    uint64_t jiffies;
+    /// jiffies 开始的时间，单位为纳秒
+    uint64_t base;
+    /// 下一个要处理的 jiffies
+    uint64_t timer_jiffies;
+    /// 等待中的定时器数量
+    size_t count;
+    /// 驱动时间轮的时钟事件
+    clock_event_t event;
+    /// 时钟事件设置的 jiffies，UINT64_MAX 表示没有设置
+    uint64_t armed;
+
+    /**
+     * @brief 时钟事件，处理到期的定时器
+     * @param  _event          时钟事件
+     */
+    static void event_handler(clock_event_t *_event);
+
+    /**
+     * @brief 按当前时间更新 jiffies
+     * @note 需要在禁止中断时调用
+     */
+    void update(void);
+
+    /**
+     * @brief 按到期时间放入对应的槽
+     * @param  _timer          定时器
+     * @note 需要在禁止中断时调用
+     */
+    void internal_add(timer_list_t *_timer);
+
+    /**
+     * @brief 从所在的槽中取出
+     * @param  _timer          定时器
+     */
+    static void detach(timer_list_t *_timer);
+
+    /**
+     * @brief 把一个槽中的定时器重新分配到前一级
+     * @param  _level          第几级，0 为 tvn[0]
+     * @param  _index          槽号
+     * @return size_t          槽号，为 0 时需要继续处理下一级
+     */
+    size_t cascade(size_t _level, size_t _index);
+
+    /**
+     * @brief 处理到当前 jiffies 为止到期的定时器
+     * @note 需要在禁止中断时调用
+     */
+    void run(void);
+
+    /**
+     * @brief 计算下一次需要处理的 jiffies
+     * @return uint64_t        jiffies，UINT64_MAX 表示没有定时器
+     * @note 只查找第一级，找不到时返回下一次重新分配的时间
+     */
+    uint64_t next_expiry(void) const;
+
+    /**
+     * @brief 设置时钟事件
+     * @param  _jiffies        到期的 jiffies
+     * @note 需要在禁止中断时调用
+     */
+    void arm(uint64_t _jiffies);
+
+public:
+    TIMER_WHEEL(void);
+    ~TIMER_WHEEL(void);
+
+    /**
+     * @brief 初始化定时器
+     * @param  _timer          定时器
+     * @param  _function       到期时调用的函数
+     * @param  _data           私有数据
+     */
+    static void init_timer(timer_list_t *_timer,
+                           void (*_function)(timer_list_t *), void *_data);
+
+    /**
+     * @brief 获取单例
+     * @return TIMER_WHEEL&     静态对象
+     * @note 只有一个 CPU，每个 CPU 的时间轮就是这个对象
+     */
+    static TIMER_WHEEL &get_instance(void);
+
+    /**
+     * @brief 初始化
+     * @note 需要在 CLOCKEVENT 初始化后调用
+     */
+    void init(void);
+
+    /**
+     * @brief 获取当前 jiffies
+     * @return uint64_t        初始化后经过的 CLOCKEVENT::TICK_NS 数
+     */
+    uint64_t get_jiffies(void);
+
+    /**
+     * @brief 添加定时器
+     * @param  _timer          由 init_timer 初始化并设置 expires，不能在等待中
+     */
+    void add_timer(timer_list_t *_timer);
+
+    /**
+     * @brief 修改定时器的到期时间，不在等待中时添加
+     * @param  _timer          定时器
+     * @param  _expires        新的到期时间，单位为 jiffies
+     * @return true            修改前在等待中
+     * @return false           修改前不在等待中
+     */
+    bool mod_timer(timer_list_t *_timer, uint64_t _expires);
+
+    /**
+     * @brief 删除定时器
+     * @param  _timer          定时器
+     * @return true            定时器在等待中，已经删除
+     * @return false           定时器不在等待中
+     */
+    bool del_timer(timer_list_t *_timer);
+
+    /**
+     * @brief 获取等待中的定时器数量
+     * @return size_t          数量
+     */
+    size_t get_count(void) const;
+};
+
+#endif /* _TIMER_WHEEL_H_ */
@@ -0,0 +1,1084 @@
+/**
+ * @file address_space.cpp
+ * @brief 地址空间实现
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#include "stdio.h"
+#include "string.h"
+#include "assert.h"
+#include "cpu.hpp"
+#include "pmm.h"
+#include "vmm.h"
+#include "zram.h"
+#include "address_space.h"
+
+size_t         ADDRESS_SPACE::asid_count      = 1;
+size_t         ADDRESS_SPACE::asid_next       = ASID_KERNEL + 1;
+uint64_t       ADDRESS_SPACE::asid_generation = 1;
+ADDRESS_SPACE *ADDRESS_SPACE::current         = nullptr;
+uintptr_t      ADDRESS_SPACE::zero_page       = 0;
+bool           ADDRESS_SPACE::merge_enabled   = false;
+ADDRESS_SPACE *ADDRESS_SPACE::merge_as        = nullptr;
+uintptr_t      ADDRESS_SPACE::merge_va        = 0;
+merge_stat_t   ADDRESS_SPACE::merge_stats     = {0, 0, 0, 0};
+
+ADDRESS_SPACE::ADDRESS_SPACE(pt_t _pgd)
+    : pgd(_pgd), active_pages(0), resident_pages(0), swapped_pages(0),
+      asid(ASID_KERNEL), generation(0) {
+    get_spaces().insert(this);
+    return;
+}
+
+ADDRESS_SPACE::ADDRESS_SPACE(void)
+    : active_pages(0), resident_pages(0), swapped_pages(0), asid(ASID_KERNEL),
+      generation(0) {
+    pgd = VMM::get_instance().alloc_pgd();
+    assert(pgd != nullptr);
+    get_spaces().insert(this);
+    return;
+}
+
+ADDRESS_SPACE::~ADDRESS_SPACE(void) {
+    assert(current != this);
+    assert(this != &get_kernel());
+    for (auto &i : vmas) {
+        release_vma(i.second);
+    }
+    // 合并扫描不再访问这个地址空间，本轮的候选页作废
+    if (merge_as == this) {
+        auto next = get_spaces().upper_bound(this);
+        merge_as  = next == get_spaces().end() ? nullptr : *next;
+        merge_va  = 0;
+    }
+    get_merge_unstable().clear();
+    get_spaces().erase(this);
+    // 这个 ASID 在回绕前不会再分配，缓存的项不会被其它地址空间使用
+    VMM::get_instance().free_pgd(pgd);
+    return;
+}
+
+bool ADDRESS_SPACE::new_asid(void) {
+    bool rollover = false;
+    // 当前代的 ASID 用完，进入下一代，之前分配的 ASID 全部失效
+    if (asid_next == asid_count) {
+        asid_generation++;
+        asid_next = ASID_KERNEL + 1;
+        rollover  = true;
+    }
+    asid       = asid_next++;
+    generation = asid_generation;
+    return rollover;
+}
+
+void ADDRESS_SPACE::invalidate(void) {
+    if (current != this && this != &get_kernel()) {
+        generation = 0;
+    }
+    return;
+}
+
+bool ADDRESS_SPACE::init(void) {
+    asid_count      = CPU::ENABLE_ASID();
+    asid_next       = ASID_KERNEL + 1;
+    asid_generation = 1;
+    current         = &get_kernel();
+    // 只读的零页，匿名区域的读缺页都映射到这一页
+    zero_page = PMM::get_instance().alloc_page();
+    assert(zero_page != 0);
+    bzero((void *)VMM_PA2VA(zero_page), COMMON::PAGE_SIZE);
+    info("address space init, asid count: 0x%X.\n", asid_count);
+    return true;
+}
+
+ADDRESS_SPACE &ADDRESS_SPACE::get_kernel(void) {
+    /// 内核地址空间，使用初始化时的页目录
+    static ADDRESS_SPACE kernel(VMM::get_instance().get_pgd());
+    return kernel;
+}
+
+ADDRESS_SPACE &ADDRESS_SPACE::get_current(void) {
+    return *current;
+}
+
+mystl::map<uintptr_t, size_t> &ADDRESS_SPACE::get_page_refs(void) {
+    static mystl::map<uintptr_t, size_t> page_refs;
+    return page_refs;
+}
+
+uintptr_t ADDRESS_SPACE::get_zero_page(void) {
+    return zero_page;
+}
+
+void ADDRESS_SPACE::ref_page(uintptr_t _pa) {
+    // 零页不会被释放，不需要计数
+    if (_pa == zero_page) {
+        return;
+    }
+    auto &refs = get_page_refs();
+    auto  it   = refs.find(_pa);
+    // 原来只有一个使用者
+    if (it == refs.end()) {
+        refs.emplace(_pa, 2);
+    }
+    else {
+        it->second++;
+    }
+    return;
+}
+
+void ADDRESS_SPACE::unref_page(uintptr_t _pa) {
+    if (_pa == zero_page) {
+        return;
+    }
+    auto &refs = get_page_refs();
+    auto  it   = refs.find(_pa);
+    // 最后一个使用者
+    if (it == refs.end()) {
+        PMM::get_instance().free_page(_pa);
+    }
+    else if (--it->second == 1) {
+        refs.erase(it);
+    }
+    return;
+}
+
+ADDRESS_SPACE::lru_list_t &ADDRESS_SPACE::get_lru(bool _active) {
+    static lru_list_t lru_active;
+    static lru_list_t lru_inactive;
+    if (_active == true) {
+        return lru_active;
+    }
+    return lru_inactive;
+}
+
+void ADDRESS_SPACE::lru_add(uintptr_t _va, bool _dirty) {
+    auto &inactive = get_lru(false);
+    inactive.push_back(lru_page_t{this, _va, false, false, _dirty});
+    auto it = inactive.end();
+    lru_pages.emplace(_va, --it);
+    resident_pages++;
+    return;
+}
+
+void ADDRESS_SPACE::lru_del(uintptr_t _start, uintptr_t _end) {
+    auto first = lru_pages.lower_bound(_start);
+    auto last  = lru_pages.lower_bound(_end);
+    for (auto it = first; it != last; ++it) {
+        auto   page  = it->second;
+        size_t pages = page->huge == true ? VMM_PAGES_PRE_PAGE_TABLE : 1;
+        if (page->active == true) {
+            active_pages -= pages;
+        }
+        resident_pages -= pages;
+        get_lru(page->active).erase(page);
+    }
+    lru_pages.erase(first, last);
+    return;
+}
+
+void ADDRESS_SPACE::lru_move(lru_list_t::iterator _it, bool _active) {
+    auto & to    = get_lru(_active);
+    size_t pages = _it->huge == true ? VMM_PAGES_PRE_PAGE_TABLE : 1;
+    if (_it->active == false && _active == true) {
+        _it->as->active_pages += pages;
+    }
+    else if (_it->active == true && _active == false) {
+        _it->as->active_pages -= pages;
+    }
+    to.splice(to.end(), get_lru(_it->active), _it);
+    _it->active = _active;
+    return;
+}
+
+bool ADDRESS_SPACE::drop_page(lru_list_t::iterator _it) {
+    uintptr_t    va  = _it->va;
+    uintptr_t    pa  = 0;
+    const vma_t *vma = find_vma(va);
+    // 大页的内容无法重新得到
+    if (_it->huge == true || vma == nullptr || get_mmap(va, &pa) == false) {
+        return false;
+    }
+    // 其它地址空间还在使用
+    if (get_page_ref(pa) > 1) {
+        return false;
+    }
+    if (_it->dirty == false &&
+        VMM::get_instance().is_dirty(pgd, va) == true) {
+        _it->dirty = true;
+    }
+    // 全为 0 的匿名页可以在缺页时重新清零，没有写入过的文件页可以重新填充
+    bool clean = true;
+    if (vma->type == vma_t::ANON) {
+        const uintptr_t *data = (const uintptr_t *)VMM_PA2VA(pa);
+        for (size_t i = 0; i < COMMON::PAGE_SIZE / sizeof(uintptr_t); i++) {
+            if (data[i] != 0) {
+                clean = false;
+                break;
+            }
+        }
+    }
+    else if (vma->type != vma_t::FILE || _it->dirty == true) {
+        clean = false;
+    }
+    // 否则压缩后保存，页表项记录保存的位置
+    if (clean == true) {
+        VMM::get_instance().unmmap(pgd, va);
+    }
+    else {
+        uintptr_t entry = ZRAM::get_instance().store((void *)VMM_PA2VA(pa));
+        if (entry == 0) {
+            return false;
+        }
+        VMM::get_instance().set_swap(pgd, va, entry);
+        swapped_pages++;
+    }
+    invalidate();
+    unref_page(pa);
+    lru_pages.erase(va);
+    get_lru(false).erase(_it);
+    resident_pages--;
+    return true;
+}
+
+uintptr_t ADDRESS_SPACE::alloc_user_page(void) {
+    uintptr_t pa = PMM::get_instance().alloc_page();
+    // 内存不足时回收不活跃的页后重试
+    if (pa == 0 && reclaim_pages(RECLAIM_BATCH) != 0) {
+        pa = PMM::get_instance().alloc_page();
+    }
+    return pa;
+}
+
+size_t ADDRESS_SPACE::age_pages(size_t _count) {
+    VMM & vmm      = VMM::get_instance();
+    auto &active   = get_lru(true);
+    auto &inactive = get_lru(false);
+    // 清除已使用位后不为其它地址空间重新分配 ASID，缓存的项只会让页显得更冷，
+    // 丢弃页时 drop_page 会使缓存失效
+    // 之后从非活跃链表移入的页在活跃链表尾部，这一轮不会被扫描
+    size_t n     = active.size() < _count ? active.size() : _count;
+    size_t moved = 0;
+    // 非活跃链表中再次被访问的页
+    auto it = inactive.begin();
+    for (size_t i = 0; i < _count && it != inactive.end(); i++) {
+        // 移动前先指向下一页
+        auto page = it++;
+        if (vmm.test_and_clear_accessed(page->as->pgd, page->va) == true) {
+            lru_move(page, true);
+        }
+    }
+    // 活跃链表中没有被访问过的页
+    for (size_t i = 0; i < n; i++) {
+        auto page = active.begin();
+        if (vmm.test_and_clear_accessed(page->as->pgd, page->va) == true) {
+            lru_move(page, true);
+        }
+        else {
+            lru_move(page, false);
+            moved++;
+        }
+    }
+    return moved;
+}
+
+size_t ADDRESS_SPACE::reclaim_pages(size_t _count) {
+    VMM & vmm      = VMM::get_instance();
+    auto &inactive = get_lru(false);
+    // 不能丢弃的页移到表尾，每页最多检查一次
+    size_t n    = inactive.size();
+    size_t done = 0;
+    auto   it   = inactive.begin();
+    for (size_t i = 0; i < n && done < _count; i++) {
+        // 移动或删除前先指向下一页
+        auto           page = it++;
+        ADDRESS_SPACE *as   = page->as;
+        if (vmm.test_and_clear_accessed(as->pgd, page->va) == true) {
+            lru_move(page, true);
+        }
+        else if (as->drop_page(page) == true) {
+            done++;
+        }
+        else {
+            lru_move(page, false);
+        }
+    }
+    return done;
+}
+
+mystl::set<ADDRESS_SPACE *> &ADDRESS_SPACE::get_spaces(void) {
+    static mystl::set<ADDRESS_SPACE *> spaces;
+    return spaces;
+}
+
+bool ADDRESS_SPACE::collapse_huge(uintptr_t _va) {
+    VMM &        vmm   = VMM::get_instance();
+    size_t       huge  = vmm.get_huge_size();
+    size_t       pages = huge / COMMON::PAGE_SIZE;
+    const vma_t *vma   = find_vma(_va);
+    if (vma == nullptr || vma->type != vma_t::ANON ||
+        _va + huge > vma->end) {
+        return false;
+    }
+    // 换出的页会被大页覆盖
+    uintptr_t entry = 0;
+    uintptr_t start = _va;
+    if (swapped_pages != 0 &&
+        vmm.next_swap(pgd, start, _va + huge, &entry) == true) {
+        return false;
+    }
+    // 统计范围中私有的页
+    size_t populated = 0;
+    size_t active    = 0;
+    auto   first     = lru_pages.lower_bound(_va);
+    auto   last      = lru_pages.lower_bound(_va + huge);
+    for (auto it = first; it != last; ++it) {
+        uintptr_t pa = 0;
+        // 已经是大页，或有与其它地址空间共享的页
+        if (it->second->huge == true || get_mmap(it->first, &pa) == false ||
+            get_page_ref(pa) > 1) {
+            return false;
+        }
+        populated++;
+        if (it->second->active == true) {
+            active++;
+        }
+    }
+    if (populated < pages && active < HUGE_HOT_PAGES) {
+        return false;
+    }
+    // 不能有不是缺页分配的映射
+    uintptr_t va     = _va;
+    uintptr_t pa     = 0;
+    size_t    mapped = 0;
+    while (vmm.next_mmap(pgd, va, _va + huge, &pa) == true) {
+        if (pa != zero_page) {
+            mapped++;
+        }
+        va += COMMON::PAGE_SIZE;
+    }
+    if (mapped != populated) {
+        return false;
+    }
+    uintptr_t block = PMM::get_instance().alloc_pages_aligned(pages, huge);
+    if (block == 0) {
+        return false;
+    }
+    // 复制已有的页，其余部分清零
+    bool dirty = false;
+    for (size_t i = 0; i < pages; i++) {
+        void *dst = (void *)VMM_PA2VA(block + i * COMMON::PAGE_SIZE);
+        va        = _va + i * COMMON::PAGE_SIZE;
+        if (get_mmap(va, &pa) == true && pa != zero_page) {
+            memcpy(dst, (void *)VMM_PA2VA(pa), COMMON::PAGE_SIZE);
+            dirty |= vmm.is_dirty(pgd, va);
+            unref_page(pa);
+        }
+        else {
+            bzero(dst, COMMON::PAGE_SIZE);
+        }
+    }
+    lru_del(_va, _va + huge);
+    vmm.collapse_huge(pgd, _va, block, vma->flag);
+    invalidate();
+    // 作为一项放入活跃链表
+    auto &lru = get_lru(true);
+    lru.push_back(lru_page_t{this, _va, true, true, dirty});
+    auto page = lru.end();
+    lru_pages.emplace(_va, --page);
+    active_pages += pages;
+    resident_pages += pages;
+    return true;
+}
+
+void ADDRESS_SPACE::split_huge(uintptr_t _va) {
+    size_t huge = VMM::get_instance().get_huge_size();
+    if (huge == 0) {
+        return;
+    }
+    uintptr_t start = _va & ~(huge - 1);
+    auto      it    = lru_pages.find(start);
+    if (it == lru_pages.end() || it->second->huge == false) {
+        return;
+    }
+    bool active = it->second->active;
+    bool dirty  = it->second->dirty;
+    VMM::get_instance().split_huge(pgd, start);
+    invalidate();
+    // 每个 4KB 页各占一项，留在原来的链表中
+    lru_del(start, start + huge);
+    for (uintptr_t va = start; va < start + huge; va += COMMON::PAGE_SIZE) {
+        lru_add(va, dirty);
+        if (active == true) {
+            lru_move(lru_pages.find(va)->second, true);
+        }
+    }
+    return;
+}
+
+void ADDRESS_SPACE::split_edges(uintptr_t _va, size_t _len) {
+    size_t huge = VMM::get_instance().get_huge_size();
+    if (huge == 0) {
+        return;
+    }
+    if ((_va & (huge - 1)) != 0) {
+        split_huge(_va);
+    }
+    if (((_va + _len) & (huge - 1)) != 0) {
+        split_huge(_va + _len);
+    }
+    return;
+}
+
+size_t ADDRESS_SPACE::promote_huge(void) {
+    size_t huge  = VMM::get_instance().get_huge_size();
+    size_t count = 0;
+    if (huge == 0) {
+        return 0;
+    }
+    for (auto as : get_spaces()) {
+        for (auto &i : as->vmas) {
+            const vma_t &vma = i.second;
+            if (vma.type != vma_t::ANON) {
+                continue;
+            }
+            // 区域中每个完整的大页范围
+            uintptr_t va = COMMON::ALIGN(vma.start, huge);
+            for (; va + huge <= vma.end; va += huge) {
+                if (as->collapse_huge(va) == true) {
+                    count++;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+mystl::map<uint32_t, uintptr_t> &ADDRESS_SPACE::get_merge_stable(void) {
+    static mystl::map<uint32_t, uintptr_t> stable;
+    return stable;
+}
+
+mystl::map<uint32_t, ADDRESS_SPACE::merge_item_t> &
+ADDRESS_SPACE::get_merge_unstable(void) {
+    static mystl::map<uint32_t, merge_item_t> unstable;
+    return unstable;
+}
+
+uint32_t ADDRESS_SPACE::hash_page(const void *_data) {
+    const uint32_t *data = (const uint32_t *)_data;
+    uint32_t        hash = 2166136261U;
+    for (size_t i = 0; i < COMMON::PAGE_SIZE / sizeof(uint32_t); i++) {
+        hash ^= data[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+bool ADDRESS_SPACE::next_anon_page(uintptr_t &_va, uintptr_t &_pa) {
+    VMM &vmm = VMM::get_instance();
+    // 从包含 _va 的区域开始
+    auto it = vmas.upper_bound(_va);
+    if (it != vmas.begin()) {
+        --it;
+    }
+    for (; it != vmas.end(); ++it) {
+        const vma_t &vma = it->second;
+        if (vma.type != vma_t::ANON || _va >= vma.end) {
+            continue;
+        }
+        if (_va < vma.start) {
+            _va = vma.start;
+        }
+        if (vmm.next_mmap(pgd, _va, vma.end, &_pa) == true) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ADDRESS_SPACE::share_page(uintptr_t _va, uintptr_t _pa,
+                               uintptr_t _shared) {
+    VMM &        vmm = VMM::get_instance();
+    const vma_t *vma = find_vma(_va);
+    auto         it  = lru_pages.find(_va);
+    // 零页不在 LRU 链表中，其它页的已修改位记录在 LRU 中
+    if (_shared == zero_page) {
+        lru_del(_va, _va + COMMON::PAGE_SIZE);
+    }
+    else {
+        it->second->dirty |= vmm.is_dirty(pgd, _va);
+    }
+    ref_page(_shared);
+    vmm.mmap_range(pgd, _va, _shared, COMMON::PAGE_SIZE,
+                   vma->flag & ~VMM_PAGE_WRITABLE);
+    invalidate();
+    unref_page(_pa);
+    return;
+}
+
+bool ADDRESS_SPACE::merge_page(uintptr_t _va, uintptr_t _pa) {
+    // 只合并独占的不活跃页，活跃的页很可能马上被写入
+    auto it = lru_pages.find(_va);
+    if (_pa == zero_page || it == lru_pages.end() ||
+        it->second->huge == true || it->second->active == true ||
+        get_page_ref(_pa) > 1) {
+        return false;
+    }
+    const void *data = (const void *)VMM_PA2VA(_pa);
+    // 全为 0 的页使用零页
+    if (memcmp(data, (const void *)VMM_PA2VA(zero_page), COMMON::PAGE_SIZE) ==
+        0) {
+        share_page(_va, _pa, zero_page);
+        return true;
+    }
+    uint32_t hash   = hash_page(data);
+    auto &   stable = get_merge_stable();
+    auto     found  = stable.find(hash);
+    // 所有使用者都已复制，这一项失效
+    if (found != stable.end() && get_page_ref(found->second) < 2) {
+        stable.erase(hash);
+    }
+    else if (found != stable.end()) {
+        // 哈希冲突时不合并
+        if (memcmp(data, (const void *)VMM_PA2VA(found->second),
+                   COMMON::PAGE_SIZE) != 0) {
+            return false;
+        }
+        share_page(_va, _pa, found->second);
+        return true;
+    }
+    auto &unstable = get_merge_unstable();
+    auto  cand     = unstable.find(hash);
+    if (cand == unstable.end()) {
+        unstable.emplace(hash, merge_item_t{this, _va});
+        return false;
+    }
+    // 候选页在记录之后可能已被修改、释放或共享，重新检查
+    ADDRESS_SPACE *as   = cand->second.as;
+    uintptr_t      va   = cand->second.va;
+    uintptr_t      pa   = 0;
+    auto           page = as->lru_pages.find(va);
+    const vma_t *  vma  = as->find_vma(va);
+    if ((as == this && va == _va) || as->get_mmap(va, &pa) == false ||
+        pa == zero_page || page == as->lru_pages.end() ||
+        page->second->huge == true || get_page_ref(pa) > 1 ||
+        vma == nullptr || vma->type != vma_t::ANON ||
+        memcmp(data, (const void *)VMM_PA2VA(pa), COMMON::PAGE_SIZE) != 0) {
+        cand->second = merge_item_t{this, _va};
+        return false;
+    }
+    // 候选页改为只读后成为共享页，内容不会再改变
+    page->second->dirty |= VMM::get_instance().is_dirty(as->pgd, va);
+    VMM::get_instance().protect_range(as->pgd, va, COMMON::PAGE_SIZE,
+                                      vma->flag & ~VMM_PAGE_WRITABLE);
+    as->invalidate();
+    share_page(_va, _pa, pa);
+    stable.emplace(hash, pa);
+    unstable.erase(hash);
+    return true;
+}
+
+void ADDRESS_SPACE::set_merge(bool _enable) {
+    merge_enabled = _enable;
+    if (_enable == false) {
+        get_merge_stable().clear();
+        get_merge_unstable().clear();
+        merge_as = nullptr;
+        merge_va = 0;
+    }
+    return;
+}
+
+size_t ADDRESS_SPACE::merge_pages(size_t _count) {
+    if (merge_enabled == false) {
+        return 0;
+    }
+    uint64_t start   = CPU::READ_TIME();
+    auto &   spaces  = get_spaces();
+    size_t   scanned = 0;
+    size_t   merged  = 0;
+    // 每次调用最多开始一轮，避免没有匿名页时空转
+    bool restarted = false;
+    while (scanned < _count) {
+        if (merge_as == nullptr) {
+            if (restarted == true) {
+                break;
+            }
+            restarted = true;
+            get_merge_unstable().clear();
+            merge_as = *spaces.begin();
+            merge_va = 0;
+        }
+        uintptr_t pa = 0;
+        // 这个地址空间扫描完毕，继续下一个
+        if (merge_as->next_anon_page(merge_va, pa) == false) {
+            auto next = spaces.upper_bound(merge_as);
+            if (next == spaces.end()) {
+                merge_as = nullptr;
+                merge_stats.passes++;
+            }
+            else {
+                merge_as = *next;
+                merge_va = 0;
+            }
+            continue;
+        }
+        if (merge_as->merge_page(merge_va, pa) == true) {
+            merged++;
+        }
+        merge_va += COMMON::PAGE_SIZE;
+        scanned++;
+    }
+    merge_stats.scanned += scanned;
+    merge_stats.merged += merged;
+    merge_stats.time += CPU::READ_TIME() - start;
+    return merged;
+}
+
+const merge_stat_t &ADDRESS_SPACE::get_merge_stat(void) {
+    return merge_stats;
+}
+
+size_t ADDRESS_SPACE::get_lru_count(bool _active) {
+    return get_lru(_active).size();
+}
+
+size_t ADDRESS_SPACE::get_working_set(void) const {
+    return active_pages;
+}
+
+size_t ADDRESS_SPACE::get_resident(void) const {
+    return resident_pages;
+}
+
+size_t ADDRESS_SPACE::get_swapped(void) const {
+    return swapped_pages;
+}
+
+size_t ADDRESS_SPACE::get_page_ref(uintptr_t _pa) {
+    auto &refs = get_page_refs();
+    auto  it   = refs.find(_pa);
+    if (it == refs.end()) {
+        return 1;
+    }
+    return it->second;
+}
+
+ADDRESS_SPACE *ADDRESS_SPACE::clone_address_space(ADDRESS_SPACE &_src) {
+    assert(&_src != &get_kernel());
+    ADDRESS_SPACE *dst = new ADDRESS_SPACE();
+    VMM &          vmm = VMM::get_instance();
+    // 大页不以只读方式共享，先拆分，写入时逐页复制
+    size_t huge = vmm.get_huge_size();
+    for (auto &i : _src.vmas) {
+        for (uintptr_t va = i.second.start; huge != 0 && va < i.second.end;
+             va += huge) {
+            _src.split_huge(va);
+        }
+    }
+    for (auto &i : _src.vmas) {
+        const vma_t &vma  = i.second;
+        uint32_t     flag = vma.flag;
+        dst->insert_vma(vma);
+        // 私有的页在两边都改为只读，PHYS 区域直接共享
+        if (vma.type != vma_t::PHYS) {
+            flag &= ~VMM_PAGE_WRITABLE;
+            vmm.protect_range(_src.pgd, vma.start, vma.end - vma.start, flag);
+        }
+        // 只复制已映射的页，物理地址连续的页一起映射
+        uintptr_t va       = vma.start;
+        uintptr_t pa       = 0;
+        uintptr_t start    = 0;
+        uintptr_t start_pa = 0;
+        size_t    len      = 0;
+        while (vmm.next_mmap(_src.pgd, va, vma.end, &pa) == true) {
+            if (vma.type != vma_t::PHYS && pa != zero_page) {
+                ref_page(pa);
+                // 新的页表项没有已修改位，记录在 LRU 中
+                bool dirty = vmm.is_dirty(_src.pgd, va);
+                auto page  = _src.lru_pages.find(va);
+                if (page != _src.lru_pages.end()) {
+                    page->second->dirty |= dirty;
+                    dirty = page->second->dirty;
+                }
+                dst->lru_add(va, dirty);
+            }
+            if (len != 0 && (start + len != va || start_pa + len != pa)) {
+                vmm.mmap_range(dst->pgd, start, start_pa, len, flag);
+                len = 0;
+            }
+            if (len == 0) {
+                start    = va;
+                start_pa = pa;
+            }
+            len += COMMON::PAGE_SIZE;
+            va += COMMON::PAGE_SIZE;
+        }
+        if (len != 0) {
+            vmm.mmap_range(dst->pgd, start, start_pa, len, flag);
+        }
+        // 换出的页共享压缩数据
+        uintptr_t entry = 0;
+        va              = vma.start;
+        while (_src.swapped_pages != 0 &&
+               vmm.next_swap(_src.pgd, va, vma.end, &entry) == true) {
+            ZRAM::get_instance().ref(entry);
+            vmm.set_swap(dst->pgd, va, entry);
+            dst->swapped_pages++;
+            va += COMMON::PAGE_SIZE;
+        }
+    }
+    _src.invalidate();
+    return dst;
+}
+
+size_t ADDRESS_SPACE::get_asid_count(void) {
+    return asid_count;
+}
+
+void ADDRESS_SPACE::switch_to(void) {
+    if (current == this) {
+        return;
+    }
+    current = this;
+    // 不支持 ASID，只能全部刷新
+    if (asid_count == 1) {
+        CPU::SET_PGD_ASID(VMM_VA2PA((uintptr_t)pgd), ASID_KERNEL, true);
+        return;
+    }
+    bool rollover = false;
+    // 内核地址空间固定使用 ASID_KERNEL，其它地址空间的 ASID 过期时重新分配
+    if (this != &get_kernel() && generation != asid_generation) {
+        rollover = new_asid();
+    }
+    CPU::SET_PGD_ASID(VMM_VA2PA((uintptr_t)pgd), asid, false);
+    // 在切换后刷新，旧 ASID 在切换前缓存的项也会被清除
+    if (rollover == true) {
+        CPU::VMM_FLUSH_ALL_ASID();
+    }
+    return;
+}
+
+pt_t ADDRESS_SPACE::get_pgd(void) const {
+    return pgd;
+}
+
+void ADDRESS_SPACE::mmap(uintptr_t _va, uintptr_t _pa, size_t _len,
+                         uint32_t _flag) {
+    VMM::get_instance().mmap_range(pgd, _va, _pa, _len, _flag);
+    invalidate();
+    return;
+}
+
+void ADDRESS_SPACE::unmmap(uintptr_t _va, size_t _len) {
+    // 两端的大页只有一部分被取消映射
+    split_edges(_va, _len);
+    // 换出的页不再需要，释放压缩数据
+    uintptr_t va    = _va;
+    uintptr_t entry = 0;
+    while (swapped_pages != 0 &&
+           VMM::get_instance().next_swap(pgd, va, _va + _len, &entry) ==
+               true) {
+        ZRAM::get_instance().free(entry);
+        swapped_pages--;
+        va += COMMON::PAGE_SIZE;
+    }
+    VMM::get_instance().unmmap_range(pgd, _va, _len);
+    lru_del(_va, _va + _len);
+    invalidate();
+    return;
+}
+
+bool ADDRESS_SPACE::get_mmap(uintptr_t _va, const void *_pa) {
+    return VMM::get_instance().get_mmap(pgd, _va, _pa);
+}
+
+bool ADDRESS_SPACE::insert_vma(const vma_t &_vma) {
+    assert((_vma.start & ~COMMON::PAGE_MASK) == 0);
+    assert((_vma.end & ~COMMON::PAGE_MASK) == 0);
+    if (_vma.end <= _vma.start || is_leaf_flag(_vma.flag) == false) {
+        return false;
+    }
+    // 内核高半部分由所有地址空间共享
+    if (_vma.end > VMM_KERNEL_HALF_START) {
+        return false;
+    }
+    // 与内核页目录共享的顶级页表项中的映射对所有地址空间可见
+    size_t top_shift = VMM_PAGE_OFF_BITS + VMM_VPN_BITS * (VMM_PT_LEVEL - 1);
+    for (uintptr_t va = _vma.start; va < _vma.end;
+         va = ((va >> top_shift) + 1) << top_shift) {
+        if (VMM::get_instance().shared(pgd, va) == true) {
+            return false;
+        }
+    }
+    // 检查是否与前后的区域重叠
+    auto next = vmas.lower_bound(_vma.start);
+    if (next != vmas.end() && next->second.start < _vma.end) {
+        return false;
+    }
+    if (next != vmas.begin()) {
+        auto prev = next;
+        --prev;
+        if (prev->second.end > _vma.start) {
+            return false;
+        }
+    }
+    vmas.emplace(_vma.start, _vma);
+    return true;
+}
+
+void ADDRESS_SPACE::release_vma(const vma_t &_vma) {
+    // PHYS 区域映射的页不属于这个区域，不释放
+    if (_vma.type != vma_t::PHYS) {
+        uintptr_t va = _vma.start;
+        uintptr_t pa = 0;
+        while (VMM::get_instance().next_mmap(pgd, va, _vma.end, &pa) ==
+               true) {
+            unref_page(pa);
+            va += COMMON::PAGE_SIZE;
+        }
+        lru_del(_vma.start, _vma.end);
+    }
+    unmmap(_vma.start, _vma.end - _vma.start);
+    return;
+}
+
+bool ADDRESS_SPACE::add_vma(uintptr_t _start, size_t _len, uint32_t _flag) {
+    vma_t vma;
+    vma.start = _start;
+    vma.end   = _start + _len;
+    vma.flag  = _flag;
+    vma.type  = vma_t::ANON;
+    vma.pa    = 0;
+    vma.off   = 0;
+    vma.fill  = nullptr;
+    vma.data  = nullptr;
+    return insert_vma(vma);
+}
+
+bool ADDRESS_SPACE::add_vma_phys(uintptr_t _start, size_t _len, uintptr_t _pa,
+                                 uint32_t _flag) {
+    vma_t vma;
+    vma.start = _start;
+    vma.end   = _start + _len;
+    vma.flag  = _flag;
+    vma.type  = vma_t::PHYS;
+    vma.pa    = _pa;
+    vma.off   = 0;
+    vma.fill  = nullptr;
+    vma.data  = nullptr;
+    return insert_vma(vma);
+}
+
+bool ADDRESS_SPACE::add_vma_file(uintptr_t _start, size_t _len,
+                                 uint32_t _flag, vma_fill_t _fill,
+                                 void *_data) {
+    assert(_fill != nullptr);
+    vma_t vma;
+    vma.start = _start;
+    vma.end   = _start + _len;
+    vma.flag  = _flag;
+    vma.type  = vma_t::FILE;
+    vma.pa    = 0;
+    vma.off   = 0;
+    vma.fill  = _fill;
+    vma.data  = _data;
+    return insert_vma(vma);
+}
+
+bool ADDRESS_SPACE::protect_vma(uintptr_t _start, size_t _len,
+                                uint32_t _flag) {
+    uintptr_t    end   = _start + _len;
+    const vma_t *found = find_vma(_start);
+    if (_len == 0 || found == nullptr || end > found->end ||
+        is_leaf_flag(_flag) == false) {
+        return false;
+    }
+    // 拆分为至多三个区域，后备的偏移随起始地址调整
+    vma_t vma = *found;
+    vmas.erase(vma.start);
+    if (vma.start < _start) {
+        vma_t head = vma;
+        head.end   = _start;
+        vmas.emplace(head.start, head);
+    }
+    if (end < vma.end) {
+        vma_t tail = vma;
+        tail.start = end;
+        tail.pa += end - vma.start;
+        tail.off += end - vma.start;
+        vmas.emplace(tail.start, tail);
+    }
+    vma_t mid = vma;
+    mid.start = _start;
+    mid.end   = end;
+    mid.flag  = _flag;
+    mid.pa += _start - vma.start;
+    mid.off += _start - vma.start;
+    vmas.emplace(mid.start, mid);
+    // 跨过边界的大页拆分后再修改
+    split_edges(_start, _len);
+    VMM &vmm = VMM::get_instance();
+    vmm.protect_range(pgd, _start, _len, _flag);
+    // 共享的页与零页仍然只读，写入时复制
+    if ((_flag & VMM_PAGE_WRITABLE) != 0 && mid.type != vma_t::PHYS) {
+        uintptr_t va = _start;
+        uintptr_t pa = 0;
+        while (vmm.next_mmap(pgd, va, end, &pa) == true) {
+            if (pa == zero_page || get_page_ref(pa) > 1) {
+                vmm.protect_range(pgd, va, COMMON::PAGE_SIZE,
+                                  _flag & ~VMM_PAGE_WRITABLE);
+            }
+            va += COMMON::PAGE_SIZE;
+        }
+    }
+    invalidate();
+    return true;
+}
+
+bool ADDRESS_SPACE::del_vma(uintptr_t _start) {
+    auto it = vmas.find(_start);
+    if (it == vmas.end()) {
+        return false;
+    }
+    release_vma(it->second);
+    vmas.erase(it);
+    return true;
+}
+
+const vma_t *ADDRESS_SPACE::find_vma(uintptr_t _va) const {
+    // 第一个起始地址大于 _va 的区域的前一个
+    auto it = vmas.upper_bound(_va);
+    if (it == vmas.begin()) {
+        return nullptr;
+    }
+    --it;
+    if (_va >= it->second.end) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+bool ADDRESS_SPACE::handle_fault(uintptr_t _va, bool _write) {
+    const vma_t *vma = find_vma(_va);
+    if (vma == nullptr) {
+        return false;
+    }
+    if (_write == true && (vma->flag & VMM_PAGE_WRITABLE) == 0) {
+        return false;
+    }
+    uintptr_t page  = _va & COMMON::PAGE_MASK;
+    uintptr_t pa    = 0;
+    uintptr_t entry = 0;
+    // 已经映射的页只可能是写入共享的只读页
+    if (get_mmap(page, &pa) == true) {
+        if (_write == false || vma->type == vma_t::PHYS) {
+            return false;
+        }
+        return copy_on_write(*vma, page, pa);
+    }
+    // 换出的页解压到新页中，内容只在内存中，视为已修改
+    if (swapped_pages != 0 &&
+        VMM::get_instance().get_swap(pgd, page, &entry) == true) {
+        pa = alloc_user_page();
+        if (pa == 0) {
+            return false;
+        }
+        ZRAM::get_instance().load(entry, (void *)VMM_PA2VA(pa));
+        ZRAM::get_instance().free(entry);
+        swapped_pages--;
+        VMM::get_instance().mmap(pgd, page, pa, vma->flag);
+        invalidate();
+        lru_add(page, true);
+        return true;
+    }
+    switch (vma->type) {
+        case vma_t::PHYS: {
+            pa = vma->pa + (page - vma->start);
+            break;
+        }
+        case vma_t::ANON: {
+            // 读取时映射只读的零页，写入时再分配
+            if (_write == false) {
+                VMM::get_instance().mmap(pgd, page, zero_page,
+                                         vma->flag & ~VMM_PAGE_WRITABLE);
+                invalidate();
+                return true;
+            }
+            // 新页通过直接映射清零
+            pa = alloc_user_page();
+            if (pa == 0) {
+                return false;
+            }
+            bzero((void *)VMM_PA2VA(pa), COMMON::PAGE_SIZE);
+            break;
+        }
+        case vma_t::FILE: {
+            pa = alloc_user_page();
+            if (pa == 0) {
+                return false;
+            }
+            if (vma->fill((void *)VMM_PA2VA(pa),
+                          page - vma->start + vma->off,
+                          vma->data) == false) {
+                PMM::get_instance().free_page(pa);
+                return false;
+            }
+            break;
+        }
+    }
+    VMM::get_instance().mmap(pgd, page, pa, vma->flag);
+    invalidate();
+    if (vma->type != vma_t::PHYS) {
+        lru_add(page, false);
+    }
+    return true;
+}
+
+bool ADDRESS_SPACE::copy_on_write(const vma_t &_vma, uintptr_t _va,
+                                  uintptr_t _pa) {
+    uintptr_t pa = _pa;
+    // 零页只需要分配新页并清零
+    if (_pa == zero_page) {
+        pa = alloc_user_page();
+        if (pa == 0) {
+            return false;
+        }
+        bzero((void *)VMM_PA2VA(pa), COMMON::PAGE_SIZE);
+        VMM::get_instance().mmap(pgd, _va, pa, _vma.flag);
+        invalidate();
+        lru_add(_va, false);
+        return true;
+    }
+    // 还有其它使用者，复制一份后放弃原来的页
+    if (get_page_ref(_pa) > 1) {
+        pa = alloc_user_page();
+        if (pa == 0) {
+            return false;
+        }
+        memcpy((void *)VMM_PA2VA(pa), (void *)VMM_PA2VA(_pa),
+               COMMON::PAGE_SIZE);
+        unref_page(_pa);
+    }
+    // 否则这个地址空间独占，直接恢复写权限
+    VMM::get_instance().mmap(pgd, _va, pa, _vma.flag);
+    invalidate();
+    return true;
+}
+
+bool ADDRESS_SPACE::page_fault(uintptr_t _va, bool _write) {
+    if (current == nullptr) {
+        return false;
+    }
+    return current->handle_fault(_va, _write);
+}
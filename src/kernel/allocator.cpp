@@ -34,3 +34,14 @@ ALLOCATOR::ALLOCATOR(const char *_name, uintptr_t _addr, size_t _len) {
 ALLOCATOR::~ALLOCATOR(void) {
     return;
 }
+
+size_t ALLOCATOR::alloc_bulk(uintptr_t *_addrs, size_t _len) {
+    size_t count = 0;
+    for (; count < _len; count++) {
+        _addrs[count] = alloc(1);
+        if (_addrs[count] == 0) {
+            break;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,56 @@
+
+/**
+ * @file allocator_resource.cpp
+ * @brief 分配器内存资源实现
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#include "stddef.h"
+#include "stdint.h"
+#include "allocator_resource.h"
+
+ALLOCATOR_RESOURCE::ALLOCATOR_RESOURCE(ALLOCATOR *_allocator, size_t _unit,
+                                       size_t _align, uintptr_t _offset)
+    : allocator(_allocator), unit(_unit), align(_align), offset(_offset) {
+    return;
+}
+
+ALLOCATOR_RESOURCE::~ALLOCATOR_RESOURCE(void) {
+    return;
+}
+
+size_t ALLOCATOR_RESOURCE::to_units(size_t _bytes) const {
+    return (_bytes + unit - 1) / unit;
+}
+
+void *ALLOCATOR_RESOURCE::do_allocate(size_t _bytes, size_t _align) {
+    // 分配器无法提供更严格的对齐
+    if (_align > align) {
+        return nullptr;
+    }
+    uintptr_t addr = allocator->alloc(to_units(_bytes));
+    if (addr == 0) {
+        return nullptr;
+    }
+    return (void *)(addr + offset);
+}
+
+void ALLOCATOR_RESOURCE::do_deallocate(void *_p, size_t _bytes, size_t) {
+    allocator->free((uintptr_t)_p - offset, to_units(_bytes));
+    return;
+}
+
+bool ALLOCATOR_RESOURCE::do_is_equal(
+    const mystl::pmr::memory_resource &_other) const noexcept {
+    // 内核不使用 RTTI，只与自身相等
+    return this == &_other;
+}
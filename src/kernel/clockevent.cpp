@@ -0,0 +1,173 @@
+/**
+ * @file clockevent.cpp
+ * @brief 时钟事件实现
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#include "stdio.h"
+#include "cpu.hpp"
+#include "intr.h"
+#include "clockevent.h"
+
+CLOCKEVENT::CLOCKEVENT(void)
+    : next(UINT64_MAX), ticks(0), wakeups(0), idle(false), handling(false) {
+    tick.expires = 0;
+    tick.handler = tick_handler;
+    tick.data    = nullptr;
+    tick.pending = false;
+    return;
+}
+
+CLOCKEVENT::~CLOCKEVENT(void) {
+    return;
+}
+
+CLOCKEVENT &CLOCKEVENT::get_instance(void) {
+    /// 定义全局 CLOCKEVENT 对象
+    static CLOCKEVENT clockevent;
+    return clockevent;
+}
+
+void CLOCKEVENT::tick_handler(clock_event_t *_event) {
+    CLOCKEVENT &clockevent = get_instance();
+    clockevent.ticks++;
+    // 空闲时不再继续
+    if (clockevent.idle == true) {
+        return;
+    }
+    // 以上次的到期时间为基准，不累积中断延迟
+    // 落后一个周期以上时跳过错过的周期，处理慢于周期时不会一直追赶
+    // 32 位架构没有 64 位除法，逐个周期跳过
+    uint64_t now = clockevent.get_time();
+    do {
+        _event->expires += TICK_NS;
+    } while (_event->expires <= now);
+    clockevent.add(_event);
+    return;
+}
+
+void CLOCKEVENT::remove(clock_event_t *_event) {
+    auto iter = events.lower_bound(_event->expires);
+    while (iter != events.end() && iter->first == _event->expires) {
+        if (iter->second == _event) {
+            events.erase(iter);
+            break;
+        }
+        ++iter;
+    }
+    _event->pending = false;
+    return;
+}
+
+void CLOCKEVENT::program(void) {
+    if (handling == true) {
+        return;
+    }
+    if (events.empty() == true) {
+        if (next != UINT64_MAX) {
+            TIMER::get_instance().stop();
+            next = UINT64_MAX;
+        }
+        return;
+    }
+    // 最早的事件没有变化时不需要重新设置
+    uint64_t expires = events.begin()->first;
+    if (expires != next) {
+        TIMER::get_instance().set_next(expires);
+        next = expires;
+    }
+    return;
+}
+
+void CLOCKEVENT::init(void) {
+    tick.expires = get_time() + TICK_NS;
+    add(&tick);
+    info("clockevent init, hz: %d.\n", HZ);
+    return;
+}
+
+uint64_t CLOCKEVENT::get_time(void) const {
+    return TIMER::get_instance().get_time();
+}
+
+void CLOCKEVENT::add(clock_event_t *_event) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    if (_event->pending == true) {
+        remove(_event);
+    }
+    events.emplace(_event->expires, _event);
+    _event->pending = true;
+    program();
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return;
+}
+
+bool CLOCKEVENT::del(clock_event_t *_event) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    bool pending = _event->pending;
+    if (pending == true) {
+        remove(_event);
+        program();
+    }
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return pending;
+}
+
+void CLOCKEVENT::handle(void) {
+    wakeups++;
+    // 设置的时钟已经到期
+    next         = UINT64_MAX;
+    uint64_t now = get_time();
+    handling     = true;
+    while (events.empty() == false && events.begin()->first <= now) {
+        clock_event_t *event = events.begin()->second;
+        events.erase(events.begin());
+        event->pending = false;
+        event->handler(event);
+    }
+    handling = false;
+    program();
+    return;
+}
+
+void CLOCKEVENT::wait_idle(void) {
+    CPU::DISABLE_INTR();
+    // 停止周期时钟，只为其它事件设置时钟
+    idle = true;
+    if (tick.pending == true) {
+        remove(&tick);
+        program();
+    }
+    // 等待任意中断，返回时中断已允许
+    CPU::WAIT_INTR();
+    CPU::DISABLE_INTR();
+    // 恢复周期时钟
+    idle         = false;
+    tick.expires = get_time() + TICK_NS;
+    add(&tick);
+    CPU::ENABLE_INTR();
+    return;
+}
+
+uint64_t CLOCKEVENT::get_ticks(void) const {
+    return ticks;
+}
+
+uint64_t CLOCKEVENT::get_wakeups(void) const {
+    return wakeups;
+}
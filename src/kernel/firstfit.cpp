@@ -118,6 +118,25 @@ bool FIRSTFIT::alloc(uintptr_t _addr, size_t _len) {
     return true;
 }
 
+size_t FIRSTFIT::alloc_bulk(uintptr_t *_addrs, size_t _len) {
+    size_t count = 0;
+    for (size_t i = 0; i < allocator_length && count < _len; i++) {
+        // 整个字都已使用时跳过
+        if ((i & MASK) == 0 && map[i >> SHIFT] == ~(uintptr_t)0) {
+            i += MASK;
+            continue;
+        }
+        if (test(i) == false) {
+            set(i);
+            _addrs[count++] = allocator_start_addr + (COMMON::PAGE_SIZE * i);
+        }
+    }
+    // 更新统计信息
+    allocator_free_count -= count;
+    allocator_used_count += count;
+    return count;
+}
+
 void FIRSTFIT::free(uintptr_t _addr, size_t _len) {
     // _addr 不在管理范围内
     if ((_addr < allocator_start_addr) ||
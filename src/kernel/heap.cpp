@@ -46,6 +46,17 @@ void HEAP::free(void *_addr) {
     return;
 }
 
+void HEAP::free_sized(void *_addr, size_t _byte) {
+    allocator->free((uintptr_t)_addr, _byte);
+    return;
+}
+
+mystl::pmr::memory_resource *HEAP::get_resource(void) {
+    // slab 以 byte 为单位，按指针大小对齐
+    static ALLOCATOR_RESOURCE resource(allocator, 1, sizeof(void *), 0);
+    return &resource;
+}
+
 /**
  * @brief malloc 定义
  * @param  _size           要申请的 bytes
@@ -63,3 +74,13 @@ extern "C" void free(void *_p) {
     HEAP::get_instance().free(_p);
     return;
 }
+
+/**
+ * @brief free_sized 定义
+ * @param  _p              要释放的内存地址
+ * @param  _size           申请时的 bytes
+ */
+extern "C" void free_sized(void *_p, size_t _size) {
+    HEAP::get_instance().free_sized(_p, _size);
+    return;
+}
@@ -41,6 +41,27 @@ int test_vmm(void);
  */
 int test_heap(void);
 
+/**
+ * @brief 节点池测试函数
+ * @return int             0 成功
+ */
+int test_pool_allocator(void);
+
+/**
+ * @brief vmalloc 测试函数
+ * @return int             0 成功
+ */
+int test_vmalloc(void);
+
+/**
+ * @brief 地址空间测试函数
+ * @return int             0 成功
+ */
+int test_address_space(void);
+int test_clockevent(void);
+int test_timer_wheel(void);
+int test_softirq(void);
+
 /**
  * @brief 输出系统信息
  */
@@ -24,7 +24,12 @@
 #include "pmm.h"
 #include "vmm.h"
 #include "heap.h"
+#include "vmalloc.h"
+#include "address_space.h"
 #include "intr.h"
+#include "clockevent.h"
+#include "timer_wheel.h"
+#include "softirq.h"
 #include "cpu.hpp"
 #include "kernel.h"
 #include "dtb.h"
@@ -32,6 +37,47 @@
 /// @todo gdb 调试
 /// @todo clion 环境
 
+/// 有需要扫描的页时，空闲时每隔这么多纳秒唤醒一次，执行后台任务
+static constexpr const uint64_t IDLE_WORK_NS = CLOCKEVENT::NS_PER_SEC / 10;
+/// 每执行这么多次后台任务尝试合并一次大页，2 的幂
+static constexpr const size_t IDLE_PROMOTE_INTERVAL = 16;
+/// 每执行这么多次后台任务扫描一次相同的页，2 的幂
+static constexpr const size_t IDLE_MERGE_INTERVAL = 4;
+
+/// 后台任务的时钟事件
+static clock_event_t idle_event;
+/// 后台任务是否到期
+static volatile bool idle_work_due = false;
+
+/**
+ * @brief 后台任务的时钟事件，只标记到期，由空闲循环执行
+ * @param  _event          时钟事件
+ */
+static void idle_work(clock_event_t *) {
+    idle_work_due = true;
+    return;
+}
+
+/**
+ * @brief 有需要扫描的页时设置后台任务的时钟事件，没有时取消
+ * 年龄扫描、大页合并与相同页合并都只处理 LRU 链表中的页，
+ * 链表为空时空闲的 CPU 不再被唤醒
+ */
+static void idle_work_update(void) {
+    CLOCKEVENT &clockevent = CLOCKEVENT::get_instance();
+    size_t      pages      = ADDRESS_SPACE::get_lru_count(true) +
+                      ADDRESS_SPACE::get_lru_count(false);
+    bool        work       = pages != 0;
+    if (work == true && idle_event.pending == false) {
+        idle_event.expires = clockevent.get_time() + IDLE_WORK_NS;
+        clockevent.add(&idle_event);
+    }
+    else if (work == false && idle_event.pending == true) {
+        clockevent.del(&idle_event);
+    }
+    return;
+}
+
 /**
  * @brief 内核主要逻辑
  * @note 这个函数不会返回
@@ -52,17 +98,68 @@ void kernel_main(void) {
     HEAP::get_instance().init();
     // 测试堆
     test_heap();
+    // 测试节点池
+    test_pool_allocator();
+    // vmalloc 初始化，需要在分配其它页目录前完成
+    VMALLOC::get_instance().init();
+    // 测试 vmalloc
+    test_vmalloc();
+    // 软中断初始化
+    SOFTIRQ::get_instance().init();
     // 中断初始化
     INTR::get_instance().init();
+    // 地址空间初始化，缺页处理需要中断
+    ADDRESS_SPACE::init();
+    // 测试地址空间
+    test_address_space();
     // 时钟中断初始化
     TIMER::get_instance().init();
+    // 时钟事件初始化
+    CLOCKEVENT::get_instance().init();
+    // 定时器初始化
+    TIMER_WHEEL::get_instance().init();
     // 允许中断
     CPU::ENABLE_INTR();
+    // 测试时钟事件
+    test_clockevent();
+    // 测试定时器
+    test_timer_wheel();
+    // 测试软中断
+    test_softirq();
     // 显示基本信息
     show_info();
+    // 空闲时周期时钟停止，只在有后台任务时定期唤醒
+    idle_event.handler = idle_work;
+    idle_event.data    = nullptr;
+    idle_event.pending = false;
     // 进入死循环
+    size_t idle = 0;
     while (1) {
-        ;
+        // 执行中断返回前没有完成的软中断
+        SOFTIRQ::get_instance().run();
+        if (idle_work_due == true) {
+            idle_work_due = false;
+            // 扫描页的使用情况，更新 LRU 与工作集
+            ADDRESS_SPACE::age_pages(ADDRESS_SPACE::AGE_BATCH);
+            // 合并填满或频繁访问的大页范围
+            if ((++idle & (IDLE_PROMOTE_INTERVAL - 1)) == 0) {
+                ADDRESS_SPACE::promote_huge();
+            }
+            // 合并内容相同的页，没有开启时直接返回
+            if ((idle & (IDLE_MERGE_INTERVAL - 1)) == 0) {
+                ADDRESS_SPACE::merge_pages(ADDRESS_SPACE::MERGE_BATCH);
+            }
+        }
+        idle_work_update();
+        // 没有等待的工作时等待下一个中断，禁止中断后检查，不会错过
+        CPU::DISABLE_INTR();
+        if (SOFTIRQ::get_instance().get_pending() == 0 &&
+            idle_work_due == false) {
+            CLOCKEVENT::get_instance().wait_idle();
+        }
+        else {
+            CPU::ENABLE_INTR();
+        }
     }
     // 不应该执行到这里
     assert(0);
@@ -21,6 +21,8 @@
 #include "boot_info.h"
 #include "resource.h"
 #include "pmm.h"
+#include "vmm.h"
+#include "vmalloc.h"
 
 // 将启动信息移动到内核空间
 void PMM::move_boot_info(void) {
@@ -32,7 +34,8 @@ void PMM::move_boot_info(void) {
     // 申请空间
     uintptr_t new_addr = get_instance().alloc_pages_kernel(pages);
     // 复制过来，完成后以前的内存就可以使用了
-    memcpy((void *)new_addr, (void *)BOOT_INFO::boot_info_addr,
+    memcpy((void *)VMM_PA2VA(new_addr),
+           (const void *)VMM_PA2VA(BOOT_INFO::boot_info_addr),
            pages * COMMON::PAGE_SIZE);
     // 设置地址
     BOOT_INFO::boot_info_addr = (uintptr_t)new_addr;
@@ -53,15 +56,21 @@ bool PMM::init(void) {
     // 设置物理地址的起点与长度
     start  = mem_info.mem.addr;
     length = mem_info.mem.len;
+    // 只使用直接映射区能覆盖的物理内存，之后都通过 VMM_PA2VA 访问
+    if (length > VMM_VA2PA(VMALLOC_START) - start) {
+        length = VMM_VA2PA(VMALLOC_START) - start;
+    }
     // 计算页数
     total_pages = length / COMMON::PAGE_SIZE;
+    // 内核链接在直接映射区中
+    uintptr_t kernel_start = VMM_VA2PA(COMMON::KERNEL_START_ADDR);
+    uintptr_t kernel_end   = VMM_VA2PA(COMMON::KERNEL_END_ADDR);
     // 内核空间地址开始
-    kernel_space_start = COMMON::KERNEL_START_ADDR;
+    kernel_space_start = kernel_start;
     // 长度手动指定
     kernel_space_length = COMMON::KERNEL_SPACE_SIZE;
     // 非内核空间在内核空间结束后
-    non_kernel_space_start =
-        COMMON::KERNEL_START_ADDR + COMMON::KERNEL_SPACE_SIZE;
+    non_kernel_space_start = kernel_start + COMMON::KERNEL_SPACE_SIZE;
     // 长度为总长度减去内核长度
     non_kernel_space_length = length - kernel_space_length;
 
@@ -80,11 +89,11 @@ bool PMM::init(void) {
 
     // 内核实际占用页数 这里也算了 0～1M 的 reserved 内存
     size_t kernel_pages =
-        (COMMON::ALIGN(COMMON::KERNEL_END_ADDR, COMMON::PAGE_SIZE) -
-         COMMON::ALIGN(COMMON::KERNEL_START_ADDR, COMMON::PAGE_SIZE)) /
+        (COMMON::ALIGN(kernel_end, COMMON::PAGE_SIZE) -
+         COMMON::ALIGN(kernel_start, COMMON::PAGE_SIZE)) /
         COMMON::PAGE_SIZE;
     // 将内核已使用部分划分出来
-    if (alloc_pages_kernel(COMMON::KERNEL_START_ADDR, kernel_pages) == true) {
+    if (alloc_pages_kernel(kernel_start, kernel_pages) == true) {
         // 将 multiboot2/dtb 信息移动到内核空间
         get_instance().move_boot_info();
         info("pmm init.\n");
@@ -95,6 +104,10 @@ bool PMM::init(void) {
     }
 }
 
+uintptr_t PMM::get_pmm_start(void) const {
+    return start;
+}
+
 size_t PMM::get_pmm_length(void) const {
     return length;
 }
@@ -134,6 +147,30 @@ bool PMM::alloc_pages(uintptr_t _addr, size_t _len) {
     return ret;
 }
 
+uintptr_t PMM::alloc_pages_aligned(size_t _len, size_t _align) {
+    uintptr_t end  = non_kernel_space_start + non_kernel_space_length;
+    uintptr_t addr = COMMON::ALIGN(non_kernel_space_start, _align);
+    // 依次尝试每个对齐的地址
+    for (; addr + _len * COMMON::PAGE_SIZE <= end; addr += _align) {
+        if (allocator->alloc(addr, _len) == true) {
+            return addr;
+        }
+    }
+    return 0;
+}
+
+bool PMM::alloc_pages_bulk(uintptr_t *_pages, size_t _len) {
+    size_t count = allocator->alloc_bulk(_pages, _len);
+    // 不足的话全部释放
+    if (count != _len) {
+        for (size_t i = 0; i < count; i++) {
+            allocator->free(_pages[i], 1);
+        }
+        return false;
+    }
+    return true;
+}
+
 uintptr_t PMM::alloc_page_kernel(void) {
     uintptr_t ret = kernel_space_allocator->alloc(1);
     return ret;
@@ -182,3 +219,10 @@ void PMM::free_pages(uintptr_t _addr, size_t _len) {
     }
     return;
 }
+
+mystl::pmr::memory_resource *PMM::get_resource(void) {
+    // firstfit 以页为单位，地址按页对齐，通过直接映射访问
+    static ALLOCATOR_RESOURCE resource(allocator, COMMON::PAGE_SIZE,
+                                       COMMON::PAGE_SIZE, KERNEL_OFFSET);
+    return &resource;
+}
@@ -97,31 +97,18 @@ void SLAB::slab_cache_t::move(chunk_t &_list, chunk_t *_node) {
 }
 
 SLAB::chunk_t *SLAB::slab_cache_t::alloc_pmm(size_t _len) {
-    // 计算页数
-    size_t pages = _len / COMMON::PAGE_SIZE;
-    if (_len % COMMON::PAGE_SIZE != 0) {
+    // 计算页数，chunk_t 也占用空间
+    size_t pages = (_len + CHUNK_SIZE) / COMMON::PAGE_SIZE;
+    if ((_len + CHUNK_SIZE) % COMMON::PAGE_SIZE != 0) {
         pages += 1;
     }
     // 申请
-    chunk_t *new_node = (chunk_t *)PMM::get_instance().alloc_pages(pages);
-    // 如果没有映射则进行映射
-    uintptr_t tmp = 0;
-    for (size_t i = 0; i < pages; i++) {
-        // 地址=初始地址+页数偏移
-        tmp = (uintptr_t)((uint8_t *)new_node + i * COMMON::PAGE_SIZE);
-        if (VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(), tmp,
-                                         0) == false) {
-            VMM::get_instance().mmap(VMM::get_instance().get_pgd(),
-                                     (uintptr_t)new_node, (uintptr_t)new_node,
-                                     VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
-        }
-        // 已经映射的情况是不应该出现的
-        else {
-            assert(0);
-        }
-    }
+    uintptr_t pa       = PMM::get_instance().alloc_pages(pages);
+    chunk_t * new_node = nullptr;
     // 不为空的话进行初始化
-    if (new_node != nullptr) {
+    if (pa != 0) {
+        // 通过直接映射访问，不需要再映射
+        new_node = (chunk_t *)VMM_PA2VA(pa);
         // 初始化
         // 自身的地址
         new_node->addr = (uintptr_t)new_node;
@@ -144,19 +131,13 @@ void SLAB::slab_cache_t::free_pmm(void) {
         pages = (tmp->len + CHUNK_SIZE) / COMMON::PAGE_SIZE;
         // 必须是整数个页
         assert(((tmp->len + CHUNK_SIZE) % COMMON::PAGE_SIZE) == 0);
-        PMM::get_instance().free_pages(tmp->addr, pages);
         // 删除节点
         tmp->prev->next = tmp->next;
         tmp->next->prev = tmp->prev;
-        // 取消映射后无法访问 tmp，所以提前保存
-        auto tmp_next = tmp->next;
-        // 取消映射
-        // 因为每次只能取消映射 1 页，所以需要循环
-        uintptr_t tmp_addr = 0;
-        for (size_t i = 0; i < pages; i++) {
-            tmp_addr = tmp->addr + i * COMMON::PAGE_SIZE;
-            VMM::get_instance().unmmap(VMM::get_instance().get_pgd(), tmp_addr);
-        }
+        // 释放后不能再访问 tmp，所以提前保存
+        auto      tmp_next = tmp->next;
+        uintptr_t tmp_addr = tmp->addr;
+        PMM::get_instance().free_pages(VMM_VA2PA(tmp_addr), pages);
         // 迭代
         tmp = tmp_next;
     }
@@ -372,7 +353,7 @@ bool SLAB::alloc(uintptr_t, size_t) {
     return true;
 }
 
-void SLAB::free(uintptr_t _addr, size_t) {
+void SLAB::free(uintptr_t _addr, size_t _len) {
     if (_addr == 0) {
         return;
     }
@@ -381,9 +362,21 @@ void SLAB::free(uintptr_t _addr, size_t) {
     chunk_t *chunk = (chunk_t *)(_addr - CHUNK_SIZE);
     assert((uintptr_t)chunk == chunk->addr);
     // 2. 计算所属 slab_cache 索引
-    auto a = chunk->len;
-    assert(chunk->len != 0);
-    auto idx = get_idx(chunk->len);
+    size_t a = 0;
+    // 调用者给出了长度，与 alloc 时一样按照 8bytes 对齐后直接计算
+    if (_len != 0) {
+        a = COMMON::ALIGN(_len, 8);
+#ifndef NDEBUG
+        // 检查调用者给出的长度与 chunk 记录的是否一致
+        assert(chunk->len == a);
+#endif
+    }
+    // 否则从 chunk 记录中读取
+    else {
+        a = chunk->len;
+    }
+    assert(a != 0);
+    auto idx = get_idx(a);
     // 3. 调用对应的 remove 函数
     slab_cache[idx].remove(chunk);
 // #define DEBUG
@@ -0,0 +1,153 @@
+/**
+ * @file softirq.cpp
+ * @brief 软中断实现
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#include "stdio.h"
+#include "assert.h"
+#include "cpu.hpp"
+#include "softirq.h"
+
+SOFTIRQ::SOFTIRQ(void)
+    : pending(0), running(false), head(nullptr), tail(nullptr) {
+    for (size_t i = 0; i < NR; i++) {
+        actions[i] = nullptr;
+    }
+    actions[TASKLET] = tasklet_action;
+    return;
+}
+
+SOFTIRQ::~SOFTIRQ(void) {
+    return;
+}
+
+SOFTIRQ &SOFTIRQ::get_instance(void) {
+    /// 定义全局 SOFTIRQ 对象
+    static SOFTIRQ softirq;
+    return softirq;
+}
+
+void SOFTIRQ::tasklet_action(void) {
+    SOFTIRQ &softirq = get_instance();
+    // 取出整个队列，执行时新调度的放在之后
+    CPU::DISABLE_INTR();
+    tasklet_t *list = softirq.head;
+    softirq.head    = nullptr;
+    softirq.tail    = nullptr;
+    CPU::ENABLE_INTR();
+    for (size_t budget = TASKLET_BUDGET; list != nullptr && budget > 0;
+         budget--) {
+        tasklet_t *tasklet = list;
+        list               = list->next;
+        // 先清除标记，执行时可以再次调度
+        tasklet->scheduled = false;
+        tasklet->func(tasklet);
+    }
+    if (list == nullptr) {
+        return;
+    }
+    // 超出预算，剩下的放回队列头，下一轮执行
+    tasklet_t *last = list;
+    while (last->next != nullptr) {
+        last = last->next;
+    }
+    CPU::DISABLE_INTR();
+    last->next = softirq.head;
+    if (softirq.head == nullptr) {
+        softirq.tail = last;
+    }
+    softirq.head = list;
+    softirq.pending |= 1 << TASKLET;
+    CPU::ENABLE_INTR();
+    return;
+}
+
+void SOFTIRQ::init(void) {
+    info("softirq init.\n");
+    return;
+}
+
+void SOFTIRQ::open(uint32_t _nr, action_t _action) {
+    assert(_nr < NR);
+    actions[_nr] = _action;
+    return;
+}
+
+void SOFTIRQ::raise(uint32_t _nr) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    pending |= 1 << _nr;
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return;
+}
+
+void SOFTIRQ::init_tasklet(tasklet_t *_tasklet, void (*_func)(tasklet_t *),
+                           void *_data) {
+    _tasklet->func      = _func;
+    _tasklet->data      = _data;
+    _tasklet->next      = nullptr;
+    _tasklet->scheduled = false;
+    return;
+}
+
+void SOFTIRQ::schedule(tasklet_t *_tasklet) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    if (_tasklet->scheduled == false) {
+        _tasklet->scheduled = true;
+        _tasklet->next      = nullptr;
+        if (tail == nullptr) {
+            head = _tasklet;
+        }
+        else {
+            tail->next = _tasklet;
+        }
+        tail = _tasklet;
+        pending |= 1 << TASKLET;
+    }
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return;
+}
+
+void SOFTIRQ::run(void) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    // 执行时产生的中断返回前不重复进入
+    if (running == false) {
+        running = true;
+        for (size_t pass = 0; pass < MAX_RESTART && pending != 0; pass++) {
+            uint32_t bits = pending;
+            pending       = 0;
+            CPU::ENABLE_INTR();
+            for (uint32_t nr = 0; nr < NR; nr++) {
+                if ((bits & (1 << nr)) != 0 && actions[nr] != nullptr) {
+                    actions[nr]();
+                }
+            }
+            CPU::DISABLE_INTR();
+        }
+        running = false;
+    }
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return;
+}
+
+uint32_t SOFTIRQ::get_pending(void) const {
+    return pending;
+}
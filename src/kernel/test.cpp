@@ -10,7 +10,21 @@
 #include "assert.h"
 #include "pmm.h"
 #include "vmm.h"
+#include "address_space.h"
 #include "heap.h"
+#include "vmalloc.h"
+#include "zram.h"
+#include "clockevent.h"
+#include "timer_wheel.h"
+#include "softirq.h"
+#include "cpu.hpp"
+#include "vector"
+#include "list"
+#include "map"
+#include "set"
+#include "unordered_map"
+#include "pool_allocator"
+#include "type_traits"
 #include "kernel.h"
 
 int32_t test_pmm(void) {
@@ -66,40 +80,49 @@ int32_t test_pmm(void) {
 int32_t test_vmm(void) {
     uintptr_t addr = 0;
     // 首先确认内核空间被映射了
+    // 内核链接在直接映射区中，物理地址为虚拟地址减去偏移
     assert(VMM::get_instance().get_pgd() != nullptr);
     assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
                                         (COMMON::KERNEL_START_ADDR + 0x1000),
                                         &addr) == 1);
-    assert(addr == COMMON::KERNEL_START_ADDR + 0x1000);
+    assert(addr == VMM_VA2PA(COMMON::KERNEL_START_ADDR) + 0x1000);
     addr = 0;
     assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
                                         COMMON::KERNEL_START_ADDR +
                                             VMM_KERNEL_SPACE_SIZE - 1,
                                         &addr) == 1);
-    assert(addr == ((COMMON::KERNEL_START_ADDR + VMM_KERNEL_SPACE_SIZE - 1) &
+    assert(addr == ((VMM_VA2PA(COMMON::KERNEL_START_ADDR) +
+                     VMM_KERNEL_SPACE_SIZE - 1) &
                     COMMON::PAGE_MASK));
     addr = 0;
-    assert(VMM::get_instance().get_mmap(
-               VMM::get_instance().get_pgd(),
-               (COMMON::ALIGN(COMMON::KERNEL_START_ADDR, 4 * COMMON::KB) +
-                VMM_KERNEL_SPACE_SIZE),
-               &addr) == 0);
-    assert(addr == 0);
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                        COMMON::KERNEL_TEXT_START_ADDR,
+                                        &addr) == 1);
+    assert(addr ==
+           (VMM_VA2PA(COMMON::KERNEL_TEXT_START_ADDR) & COMMON::PAGE_MASK));
+    // 内核的物理地址没有恒等映射
     addr = 0;
     assert(VMM::get_instance().get_mmap(
                VMM::get_instance().get_pgd(),
-               (COMMON::ALIGN(COMMON::KERNEL_START_ADDR, 4 * COMMON::KB) +
-                VMM_KERNEL_SPACE_SIZE + 0x1024),
-               0) == 0);
+               VMM_VA2PA(COMMON::KERNEL_START_ADDR) + 0x1000, &addr) == 0);
+    assert(addr == 0);
+    // 直接映射区覆盖所有物理内存
+    uintptr_t last = PMM::get_instance().get_pmm_start() +
+                     PMM::get_instance().get_pmm_length() - COMMON::PAGE_SIZE;
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                        VMM_PA2VA(last), &addr) == 1);
+    assert(addr == (last & COMMON::PAGE_MASK));
     // 测试映射与取消映射
     addr = 0;
-    // 准备映射的虚拟地址 3GB 处
-    uintptr_t va = 0xC0000000;
+    // 准备映射的虚拟地址 1GB 处，位于低地址
+    uintptr_t va = 0x40000000;
     // 准备映射的物理地址 0.75GB 处
     uintptr_t pa = 0x30000000;
     // 确定一块未映射的内存
     assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(), va,
                                         nullptr) == 0);
+    // 映射时会申请页表，全部取消映射后应该被回收
+    size_t free_pages = PMM::get_instance().get_free_pages_count();
     // 映射
     VMM::get_instance().mmap(VMM::get_instance().get_pgd(), va, pa,
                              VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
@@ -113,10 +136,299 @@ int32_t test_vmm(void) {
     assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(), va,
                                         &addr) == 0);
     assert(addr == 0);
+    // 大页映射，va 与 pa 都按 2MB 对齐
+    size_t huge = 2 * COMMON::MB;
+    VMM::get_instance().mmap_range(VMM::get_instance().get_pgd(), va, pa, huge,
+                                   VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                        va + 0x1234, &addr) == 1);
+    assert(addr == pa + 0x1000);
+    // 取消大页中一页的映射会拆分大页，其余页不受影响
+    VMM::get_instance().unmmap(VMM::get_instance().get_pgd(), va + 0x1000);
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                        va + 0x1000, &addr) == 0);
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                        va + huge - 1, &addr) == 1);
+    assert(addr == pa + huge - COMMON::PAGE_SIZE);
+    VMM::get_instance().unmmap_range(VMM::get_instance().get_pgd(), va, huge);
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(), va,
+                                        nullptr) == 0);
+    // 跨越页表边界的范围映射
+    uintptr_t va2 = va + huge - 2 * COMMON::PAGE_SIZE;
+    VMM::get_instance().mmap_range(VMM::get_instance().get_pgd(), va2, pa,
+                                   4 * COMMON::PAGE_SIZE,
+                                   VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
+    for (size_t i = 0; i < 4; i++) {
+        assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                            va2 + i * COMMON::PAGE_SIZE,
+                                            &addr) == 1);
+        assert(addr == pa + i * COMMON::PAGE_SIZE);
+    }
+    // 物理地址连续的页合并为一段
+    vmm_sg_t sg[2];
+    assert(VMM::get_instance().get_mmap_sg(VMM::get_instance().get_pgd(),
+                                           va2 + 0x10, 3 * COMMON::PAGE_SIZE,
+                                           sg, 2) == 1);
+    assert(sg[0].pa == pa + 0x10 && sg[0].len == 3 * COMMON::PAGE_SIZE);
+    // 重新映射后缓存的结果失效
+    VMM::get_instance().unmmap(VMM::get_instance().get_pgd(), va2);
+    VMM::get_instance().mmap(VMM::get_instance().get_pgd(), va2,
+                             pa + huge, VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(), va2,
+                                        &addr) == 1);
+    assert(addr == pa + huge);
+    assert(VMM::get_instance().get_mmap_sg(VMM::get_instance().get_pgd(),
+                                           va2, 4 * COMMON::PAGE_SIZE, sg,
+                                           2) == 2);
+    assert(sg[1].pa == pa + COMMON::PAGE_SIZE &&
+           sg[1].len == 3 * COMMON::PAGE_SIZE);
+    // 有未映射的页时失败
+    assert(VMM::get_instance().get_mmap_sg(VMM::get_instance().get_pgd(),
+                                           va2, 5 * COMMON::PAGE_SIZE, sg,
+                                           2) == 0);
+    VMM::get_instance().unmmap_range(VMM::get_instance().get_pgd(), va2,
+                                     4 * COMMON::PAGE_SIZE);
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                        va + huge, nullptr) == 0);
+    assert(PMM::get_instance().get_free_pages_count() == free_pages);
     info("vmm test done.\n");
     return 0;
 }
 
+int test_address_space(void) {
+    auto &kernel = ADDRESS_SPACE::get_kernel();
+    assert(&ADDRESS_SPACE::get_current() == &kernel);
+    // 低地址的顶级页表项都不与内核共享，这里取第 3 个
+    uintptr_t va = (uintptr_t)3
+                   << (VMM_PAGE_OFF_BITS + VMM_VPN_BITS * (VMM_PT_LEVEL - 1));
+    uintptr_t pa = PMM::get_instance().alloc_page_kernel();
+    assert(pa != 0);
+    auto      as1 = new ADDRESS_SPACE();
+    auto      as2 = new ADDRESS_SPACE();
+    uintptr_t pa1 = 0;
+    // 新的地址空间包含内核的映射
+    assert(as1->get_mmap(COMMON::KERNEL_START_ADDR, nullptr) == true);
+    // 虚拟内存区域
+    size_t len = 4 * COMMON::PAGE_SIZE;
+    assert(as1->add_vma(va, len, VMM_PAGE_READABLE | VMM_PAGE_WRITABLE));
+    assert(as1->add_vma(va + COMMON::PAGE_SIZE, COMMON::PAGE_SIZE,
+                        VMM_PAGE_READABLE) == false);
+    assert(as1->add_vma(va - COMMON::PAGE_SIZE, len, VMM_PAGE_READABLE) ==
+           false);
+    // 内核高半部分不能作为用户区域，页表由所有地址空间共享
+    assert(as1->add_vma(VMM_KERNEL_HALF_START, COMMON::PAGE_SIZE,
+                        VMM_PAGE_READABLE) == false);
+    size_t top_shift = VMM_PAGE_OFF_BITS + VMM_VPN_BITS * (VMM_PT_LEVEL - 1);
+    size_t half = (VMM_KERNEL_HALF_START >> top_shift) & VMM_VPN_BITS_MASK;
+    for (size_t i = 0; i < half; i++) {
+        assert((as1->get_pgd()[i] & VMM_PAGE_VALID) == 0);
+    }
+    for (size_t i = half; i < VMM_PAGES_PRE_PAGE_TABLE; i++) {
+        assert((as1->get_pgd()[i] & VMM_PAGE_VALID) == VMM_PAGE_VALID);
+        assert(as1->get_pgd()[i] == kernel.get_pgd()[i]);
+    }
+    // 内核页目录的顶级页表项都与其它地址空间共享，低地址也不能添加区域
+    assert(VMM::get_instance().shared(kernel.get_pgd(), va) == true);
+    assert(VMM::get_instance().shared(as1->get_pgd(), va) == false);
+    assert(kernel.add_vma(va, COMMON::PAGE_SIZE, VMM_PAGE_READABLE) == false);
+    assert(kernel.find_vma(va) == nullptr);
+#ifdef __riscv
+    // 没有 R/W/X 的页表项指向下一级页表，W 不能单独设置
+    assert(as1->add_vma(va + len, COMMON::PAGE_SIZE, 0) == false);
+    assert(as1->add_vma(va + len, COMMON::PAGE_SIZE, VMM_PAGE_WRITABLE) ==
+           false);
+    assert(as1->protect_vma(va, COMMON::PAGE_SIZE, 0) == false);
+    assert(as1->find_vma(va)->flag == (VMM_PAGE_READABLE | VMM_PAGE_WRITABLE));
+#endif
+    assert(as1->find_vma(va + len - 1)->start == va);
+    assert(as1->find_vma(va + len) == nullptr);
+    assert(as1->find_vma(va - 1) == nullptr);
+    // 映射只对 as1 可见
+    size_t free_pages = PMM::get_instance().get_free_pages_count();
+    as1->mmap(va, pa, COMMON::PAGE_SIZE,
+              VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
+    assert(as1->get_mmap(va, nullptr) == true);
+    assert(as2->get_mmap(va, nullptr) == false);
+    as1->switch_to();
+    *(uint32_t *)va = 0x2333;
+    assert(*(uint32_t *)VMM_PA2VA(pa) == 0x2333);
+    as2->switch_to();
+    as1->switch_to();
+    assert(*(uint32_t *)va == 0x2333);
+    // 用完所有 ASID，回绕后仍能正确访问
+    for (size_t i = 0; i < ADDRESS_SPACE::get_asid_count() + 1; i++) {
+        ADDRESS_SPACE as;
+        as.switch_to();
+        kernel.switch_to();
+    }
+    as1->switch_to();
+    *(uint32_t *)VMM_PA2VA(pa) = 0x6666;
+    assert(*(uint32_t *)va == 0x6666);
+    kernel.switch_to();
+    as1->unmmap(va, COMMON::PAGE_SIZE);
+    assert(as1->get_mmap(va, nullptr) == false);
+    assert(PMM::get_instance().get_free_pages_count() == free_pages);
+    // 区域中的页在首次访问时分配，读取时映射零页
+    as1->switch_to();
+    *(uint32_t *)(va + 2 * COMMON::PAGE_SIZE) = 0x2333;
+    size_t used = PMM::get_instance().get_free_pages_count();
+    assert(*(uint32_t *)(va + COMMON::PAGE_SIZE) == 0);
+    assert(as1->get_mmap(va + COMMON::PAGE_SIZE, &pa1) == true);
+    assert(pa1 == ADDRESS_SPACE::get_zero_page());
+    assert(PMM::get_instance().get_free_pages_count() == used);
+    assert(as1->get_mmap(va + 2 * COMMON::PAGE_SIZE, nullptr) == true);
+    assert(as1->get_mmap(va, nullptr) == false);
+    assert(as1->get_mmap(va + 3 * COMMON::PAGE_SIZE, nullptr) == false);
+    kernel.switch_to();
+    // 复制的地址空间共享已映射的页，写入时才复制
+    auto      as3 = ADDRESS_SPACE::clone_address_space(*as1);
+    uintptr_t pa3 = 0;
+    assert(as1->get_mmap(va + 2 * COMMON::PAGE_SIZE, &pa1) == true);
+    assert(as3->get_mmap(va + 2 * COMMON::PAGE_SIZE, &pa3) == true);
+    assert(pa1 == pa3 && ADDRESS_SPACE::get_page_ref(pa1) == 2);
+    assert(as3->get_mmap(va, nullptr) == false);
+    as3->switch_to();
+    assert(*(uint32_t *)(va + 2 * COMMON::PAGE_SIZE) == 0x2333);
+    *(uint32_t *)(va + 2 * COMMON::PAGE_SIZE) = 0x6666;
+    assert(as3->get_mmap(va + 2 * COMMON::PAGE_SIZE, &pa3) == true);
+    assert(pa3 != pa1 && ADDRESS_SPACE::get_page_ref(pa1) == 1);
+    // 只剩一个使用者，写入时不再复制
+    as1->switch_to();
+    assert(*(uint32_t *)(va + 2 * COMMON::PAGE_SIZE) == 0x2333);
+    *(uint32_t *)(va + 2 * COMMON::PAGE_SIZE) = 0x2334;
+    assert(as1->get_mmap(va + 2 * COMMON::PAGE_SIZE, &pa3) == true);
+    assert(pa3 == pa1);
+    kernel.switch_to();
+    delete as3;
+    assert(ADDRESS_SPACE::get_page_ref(pa1) == 1);
+    // 写入零页时分配私有的页
+    as1->switch_to();
+    *(uint32_t *)(va + COMMON::PAGE_SIZE) = 0;
+    assert(as1->get_mmap(va + COMMON::PAGE_SIZE, &pa3) == true);
+    assert(pa3 != ADDRESS_SPACE::get_zero_page());
+    assert(*(uint32_t *)VMM_PA2VA(ADDRESS_SPACE::get_zero_page()) == 0);
+    // 新映射的页在非活跃链表中，再次被访问后才进入活跃链表
+    assert(as1->get_resident() == 2 && as1->get_working_set() == 0);
+    ADDRESS_SPACE::age_pages(ADDRESS_SPACE::AGE_BATCH);
+    assert(as1->get_working_set() == 2);
+    // 只访问其中一页
+    assert(*(uint32_t *)(va + 2 * COMMON::PAGE_SIZE) == 0x2334);
+    ADDRESS_SPACE::age_pages(ADDRESS_SPACE::AGE_BATCH);
+    assert(as1->get_working_set() == 1);
+    // 内容全为 0 的不活跃页直接丢弃
+    size_t inactive = ADDRESS_SPACE::get_lru_count(false);
+    assert(ADDRESS_SPACE::reclaim_pages(inactive) == 1);
+    assert(as1->get_mmap(va + COMMON::PAGE_SIZE, nullptr) == false);
+    assert(as1->get_resident() == 1);
+    assert(as1->get_swapped() == 0);
+    // 丢弃的页再次读取时映射零页
+    assert(*(uint32_t *)(va + COMMON::PAGE_SIZE) == 0);
+    assert(as1->get_resident() == 1);
+    // 写入过的页不再被访问后压缩保存
+    ADDRESS_SPACE::age_pages(ADDRESS_SPACE::AGE_BATCH);
+    assert(as1->get_working_set() == 0);
+    inactive = ADDRESS_SPACE::get_lru_count(false);
+    assert(ADDRESS_SPACE::reclaim_pages(inactive) == 1);
+    assert(as1->get_mmap(va + 2 * COMMON::PAGE_SIZE, nullptr) == false);
+    assert(as1->get_resident() == 0 && as1->get_swapped() == 1);
+    assert(ZRAM::get_instance().get_stored() == 1);
+    // 访问时解压到新的页
+    assert(*(uint32_t *)(va + 2 * COMMON::PAGE_SIZE) == 0x2334);
+    assert(as1->get_resident() == 1 && as1->get_swapped() == 0);
+    assert(ZRAM::get_instance().get_stored() == 0);
+    assert(ZRAM::get_instance().get_pool_pages() == 0);
+    kernel.switch_to();
+    // 删除区域时释放分配的页与页表，LRU 等簿记结构占用的堆页不归还
+    used = PMM::get_instance().get_free_pages_count();
+    assert(as1->del_vma(va) == true);
+    assert(as1->find_vma(va) == nullptr);
+    assert(as1->get_mmap(va + 2 * COMMON::PAGE_SIZE, nullptr) == false);
+    assert((as1->get_pgd()[(va >> top_shift) & VMM_VPN_BITS_MASK] &
+            VMM_PAGE_VALID) == 0);
+    assert(PMM::get_instance().get_free_pages_count() >= used + VMM_PT_LEVEL);
+    delete as1;
+    delete as2;
+    PMM::get_instance().free_page(pa);
+    // 开启合并后，内容相同的不活跃页合并为一个只读的共享页
+    auto as5 = new ADDRESS_SPACE();
+    auto as6 = new ADDRESS_SPACE();
+    assert(as5->add_vma(va, 2 * COMMON::PAGE_SIZE,
+                        VMM_PAGE_READABLE | VMM_PAGE_WRITABLE) == true);
+    assert(as6->add_vma(va, COMMON::PAGE_SIZE,
+                        VMM_PAGE_READABLE | VMM_PAGE_WRITABLE) == true);
+    as5->switch_to();
+    *(uint32_t *)va                       = 0x2333;
+    *(uint32_t *)(va + COMMON::PAGE_SIZE) = 0;
+    as6->switch_to();
+    *(uint32_t *)va = 0x2333;
+    kernel.switch_to();
+    assert(ADDRESS_SPACE::merge_pages(ADDRESS_SPACE::MERGE_BATCH) == 0);
+    ADDRESS_SPACE::set_merge(true);
+    assert(ADDRESS_SPACE::merge_pages(ADDRESS_SPACE::MERGE_BATCH) == 2);
+    assert(as5->get_mmap(va, &pa1) == true);
+    assert(as6->get_mmap(va, &pa3) == true);
+    assert(pa1 == pa3 && ADDRESS_SPACE::get_page_ref(pa1) == 2);
+    // 全为 0 的页使用零页
+    assert(as5->get_mmap(va + COMMON::PAGE_SIZE, &pa3) == true);
+    assert(pa3 == ADDRESS_SPACE::get_zero_page());
+    assert(as5->get_resident() == 1 && as6->get_resident() == 1);
+    assert(ADDRESS_SPACE::get_merge_stat().merged == 2);
+    // 写入时复制，另一个地址空间不受影响
+    as6->switch_to();
+    *(uint32_t *)va = 0x6666;
+    assert(as6->get_mmap(va, &pa3) == true);
+    assert(pa3 != pa1 && ADDRESS_SPACE::get_page_ref(pa1) == 1);
+    as5->switch_to();
+    assert(*(uint32_t *)va == 0x2333);
+    kernel.switch_to();
+    ADDRESS_SPACE::set_merge(false);
+    delete as5;
+    delete as6;
+    // 填满的大页范围合并为一个大页
+    size_t huge = VMM::get_instance().get_huge_size();
+    if (huge != 0) {
+        auto as4 = new ADDRESS_SPACE();
+        assert(as4->add_vma(va, 2 * huge,
+                            VMM_PAGE_READABLE | VMM_PAGE_WRITABLE) == true);
+        as4->switch_to();
+        for (size_t i = 0; i < huge / COMMON::PAGE_SIZE; i++) {
+            *(uint32_t *)(va + i * COMMON::PAGE_SIZE) = i;
+        }
+        // 第二个范围只有一页，不合并
+        *(uint32_t *)(va + huge) = 0x2333;
+        assert(ADDRESS_SPACE::promote_huge() == 1);
+        assert(as4->get_mmap(va, &pa1) == true);
+        assert((pa1 & (huge - 1)) == 0);
+        assert(as4->get_mmap(va + 5 * COMMON::PAGE_SIZE, &pa3) == true);
+        assert(pa3 == pa1 + 5 * COMMON::PAGE_SIZE);
+        for (size_t i = 0; i < huge / COMMON::PAGE_SIZE; i++) {
+            assert(*(uint32_t *)(va + i * COMMON::PAGE_SIZE) == i);
+        }
+        assert(as4->get_resident() == huge / COMMON::PAGE_SIZE + 1);
+        // 修改一部分的属性时拆分，映射的物理页不变
+        assert(as4->protect_vma(va + COMMON::PAGE_SIZE, COMMON::PAGE_SIZE,
+                                VMM_PAGE_READABLE) == true);
+        assert(as4->find_vma(va + COMMON::PAGE_SIZE)->start ==
+               va + COMMON::PAGE_SIZE);
+        assert(as4->get_mmap(va + 5 * COMMON::PAGE_SIZE, &pa3) == true);
+        assert(pa3 == pa1 + 5 * COMMON::PAGE_SIZE);
+        assert(*(uint32_t *)(va + COMMON::PAGE_SIZE) == 1);
+        *(uint32_t *)va = 0x6666;
+        assert(*(uint32_t *)VMM_PA2VA(pa1) == 0x6666);
+        assert(as4->get_resident() == huge / COMMON::PAGE_SIZE + 1);
+        // 跨过多个区域的范围不再合并
+        assert(ADDRESS_SPACE::promote_huge() == 0);
+        kernel.switch_to();
+        delete as4;
+        // 大页的物理块全部释放
+        assert(PMM::get_instance().alloc_pages(
+                   pa1, huge / COMMON::PAGE_SIZE) == true);
+        PMM::get_instance().free_pages(pa1, huge / COMMON::PAGE_SIZE);
+    }
+    info("address space test done.\n");
+    return 0;
+}
+
 // TODO: 更多测试
 int test_heap(void) {
     // 根据字长不同 CHUNK_SIZE 是不一样的
@@ -156,6 +468,362 @@ int test_heap(void) {
     HEAP::get_instance().free(addr2);
     HEAP::get_instance().free(addr3);
     HEAP::get_instance().free(addr4);
+    // 已知长度的释放
+    addr2 = HEAP::get_instance().malloc(0x1);
+    assert(addr2 != nullptr);
+    addr3 = HEAP::get_instance().malloc(0x300);
+    assert(addr3 != nullptr);
+    HEAP::get_instance().free_sized(addr3, 0x300);
+    HEAP::get_instance().free_sized(addr2, 0x1);
+    // 按长度释放的块回到对应的 cache，可以再次申请和释放
+    addr4 = HEAP::get_instance().malloc(0x1);
+    assert(addr4 != nullptr);
+    HEAP::get_instance().free_sized(addr4, 0x1);
+    addr4 = HEAP::get_instance().malloc(0x300);
+    assert(addr4 != nullptr);
+    HEAP::get_instance().free_sized(addr4, 0x300);
+    // 整页大小的块加上 chunk 超过一页，末尾所在的页也属于堆
+    addr1 = HEAP::get_instance().malloc(COMMON::PAGE_SIZE);
+    assert(addr1 != nullptr);
+    uintptr_t last =
+        VMM_VA2PA((uintptr_t)addr1 + COMMON::PAGE_SIZE - 1) & COMMON::PAGE_MASK;
+    assert(PMM::get_instance().alloc_pages(last, 1) == false);
+    HEAP::get_instance().free(addr1);
+    // pmr: 池资源从堆资源取得块，析构时全部归还
+    {
+        mystl::pmr::unsynchronized_pool_resource pool(
+            HEAP::get_instance().get_resource());
+        mystl::pmr::vector<uint32_t> v(&pool);
+        for (uint32_t i = 0; i < 0x100; i++) {
+            v.push_back(i);
+        }
+        assert(v.size() == 0x100 && v[0xFF] == 0xFF);
+        assert(v.get_allocator().resource() == &pool);
+        // 最大的大小类经过多次补充，每次的块都不能超过堆的上限
+        size_t largest = sizeof(void *) << 9;
+        for (size_t i = 0; i < 0x40; i++) {
+            addr1 = pool.allocate(largest);
+            assert(addr1 != nullptr);
+            assert(((uintptr_t)addr1 & (largest - 1)) == 0);
+        }
+    }
+    // 比堆更严格的对齐由 new_delete_resource 自行处理
+    addr1 = mystl::pmr::new_delete_resource()->allocate(0x80, 0x100);
+    assert(addr1 != nullptr);
+    assert(((uintptr_t)addr1 & 0xFF) == 0);
+    mystl::pmr::new_delete_resource()->deallocate(addr1, 0x80, 0x100);
     info("heap test done.\n");
     return 0;
 }
+
+/// 测试节点池用的对象，比空闲链表中的指针大
+struct pool_test_t {
+    uint64_t data[5];
+};
+
+int test_pool_allocator(void) {
+    // list: 节点超过一个块，删除后重新插入使用刚释放的节点
+    {
+        mystl::list<uint32_t, mystl::pool_allocator<uint32_t>> l;
+        for (uint32_t i = 0; i < 0x100; i++) {
+            l.push_back(i);
+        }
+        assert(l.size() == 0x100 && l.front() == 0 && l.back() == 0xFF);
+        uint32_t *addr = &l.back();
+        l.pop_back();
+        l.push_back(0x100);
+        assert(&l.back() == addr && l.back() == 0x100);
+        l.clear();
+        assert(l.empty() == true);
+    }
+    // map
+    {
+        mystl::map<uint32_t, uint32_t, mystl::less<uint32_t>,
+                   mystl::pool_allocator<mystl::pair<const uint32_t, uint32_t>>>
+            m;
+        for (uint32_t i = 0; i < 0x100; i++) {
+            m.emplace(i, i * 2);
+        }
+        assert(m.size() == 0x100 && m.find(0x80)->second == 0x100);
+        const uint32_t *addr = &m.find(0x80)->first;
+        assert(m.erase(0x80) == 1);
+        assert(m.find(0x80) == m.end());
+        m.emplace(0x80, 1);
+        assert(&m.find(0x80)->first == addr && m.find(0x80)->second == 1);
+        assert(m.size() == 0x100);
+    }
+    // set
+    {
+        mystl::set<uint32_t, mystl::less<uint32_t>,
+                   mystl::pool_allocator<uint32_t>>
+            s;
+        for (uint32_t i = 0; i < 0x100; i++) {
+            s.insert(i);
+        }
+        assert(s.size() == 0x100 && *s.begin() == 0);
+        const uint32_t *addr = &*s.find(0x10);
+        assert(s.erase(0x10) == 1);
+        assert(s.find(0x10) == s.end());
+        assert(&*s.insert(0x10).first == addr);
+        assert(s.size() == 0x100);
+    }
+    // unordered_map
+    {
+        mystl::unordered_map<
+            uint32_t, uint32_t, mystl::hash<uint32_t>,
+            mystl::equal_to<uint32_t>,
+            mystl::pool_allocator<mystl::pair<const uint32_t, uint32_t>>>
+            m;
+        for (uint32_t i = 0; i < 0x100; i++) {
+            m.emplace(i, i + 1);
+        }
+        assert(m.size() == 0x100 && m.find(0xFF)->second == 0x100);
+        const uint32_t *addr = &m.find(0x20)->first;
+        assert(m.erase(0x20) == 1);
+        assert(m.find(0x20) == m.end());
+        m.emplace(0x20, 0);
+        assert(&m.find(0x20)->first == addr && m.find(0x20)->second == 0);
+        assert(m.size() == 0x100);
+    }
+    // rebind 得到节点类型的池，每个对象至少占用节点的大小
+    typedef mystl::pool_allocator<uint32_t>::rebind<pool_test_t>::other
+        rebind_t;
+    static_assert(
+        std::is_same<rebind_t, mystl::pool_allocator<pool_test_t>>::value,
+        "pool_allocator: rebind");
+    pool_test_t *a = rebind_t::allocate(1);
+    pool_test_t *b = rebind_t::allocate(1);
+    assert(a != nullptr && b != nullptr && a != b);
+    uintptr_t diff = (uintptr_t)a > (uintptr_t)b
+                       ? (uintptr_t)a - (uintptr_t)b
+                       : (uintptr_t)b - (uintptr_t)a;
+    assert(diff >= sizeof(pool_test_t));
+    // 写满两个对象，互不覆盖
+    for (size_t i = 0; i < 5; i++) {
+        a->data[i] = i;
+        b->data[i] = ~(uint64_t)i;
+    }
+    for (size_t i = 0; i < 5; i++) {
+        assert(a->data[i] == i && b->data[i] == ~(uint64_t)i);
+    }
+    // 多个对象不从池中分配
+    pool_test_t *c = rebind_t::allocate(4);
+    assert(c != nullptr);
+    rebind_t::deallocate(c, 4);
+    // 释放后重新分配，得到最后释放的对象
+    rebind_t::deallocate(b, 1);
+    rebind_t::deallocate(a, 1);
+    assert(rebind_t::allocate(1) == a);
+    assert(rebind_t::allocate(1) == b);
+    rebind_t::deallocate(a, 1);
+    rebind_t::deallocate(b, 1);
+    info("pool_allocator test done.\n");
+    return 0;
+}
+
+int test_vmalloc(void) {
+    // 超过一个页表能容纳的页，需要分多批映射
+    size_t pages = VMM_PAGES_PRE_PAGE_TABLE + 3;
+    // 先分配释放一次，堆中的簿记结构留在缓存里，之后的页数才能对上
+    VMALLOC::get_instance().vfree(
+        VMALLOC::get_instance().vmalloc(pages * COMMON::PAGE_SIZE));
+    size_t free_count = PMM::get_instance().get_free_pages_count();
+    uint8_t * buf   = (uint8_t *)VMALLOC::get_instance().vmalloc(
+        pages * COMMON::PAGE_SIZE);
+    uintptr_t pa    = 0;
+    assert(buf != nullptr);
+    assert(((uintptr_t)buf & (COMMON::PAGE_SIZE - 1)) == 0);
+    // 页表和临时缓冲区可能还会占用一些页
+    assert(PMM::get_instance().get_free_pages_count() <= free_count - pages);
+    // 每一页都已映射且可写
+    for (size_t i = 0; i < pages; i++) {
+        buf[i * COMMON::PAGE_SIZE] = (uint8_t)i;
+        assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                            (uintptr_t)buf +
+                                                i * COMMON::PAGE_SIZE,
+                                            &pa) == true);
+        assert(*(uint8_t *)VMM_PA2VA(pa) == (uint8_t)i);
+    }
+    // 之后的保护页没有映射
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                        (uintptr_t)buf +
+                                            pages * COMMON::PAGE_SIZE,
+                                        nullptr) == false);
+    VMALLOC::get_instance().vfree(buf);
+    assert(PMM::get_instance().get_free_pages_count() == free_count);
+    assert(VMM::get_instance().get_mmap(VMM::get_instance().get_pgd(),
+                                        (uintptr_t)buf, nullptr) == false);
+    // 不连续的物理页映射到连续的地址
+    uintptr_t frames[2];
+    frames[0]     = PMM::get_instance().alloc_page();
+    frames[1]     = PMM::get_instance().alloc_page();
+    uint32_t *map = (uint32_t *)VMALLOC::get_instance().vmap(
+        frames, 2, VMM_PAGE_READABLE | VMM_PAGE_WRITABLE);
+    assert(map != nullptr);
+    map[0] = 0xCAFEBABE;
+    // 第二页
+    map[COMMON::PAGE_SIZE / sizeof(uint32_t)] = 0xDEADBEEF;
+    assert(*(uint32_t *)VMM_PA2VA(frames[0]) == 0xCAFEBABE);
+    assert(*(uint32_t *)VMM_PA2VA(frames[1]) == 0xDEADBEEF);
+    // vfree 不释放 vmap 的物理页
+    VMALLOC::get_instance().vfree(map);
+    assert(PMM::get_instance().get_free_pages_count() == free_count - 2);
+    PMM::get_instance().free_page(frames[0]);
+    PMM::get_instance().free_page(frames[1]);
+    assert(PMM::get_instance().get_free_pages_count() == free_count);
+    info("vmalloc test done.\n");
+    return 0;
+}
+
+/// 时钟事件执行的顺序
+static size_t clockevent_order;
+
+/**
+ * @brief 测试用的时钟事件，记录执行的顺序
+ * @param  _event          时钟事件
+ */
+static void test_clockevent_handler(clock_event_t *_event) {
+    *(size_t *)_event->data = clockevent_order++;
+    return;
+}
+
+int test_clockevent(void) {
+    CLOCKEVENT &  clockevent = CLOCKEVENT::get_instance();
+    size_t        fired[3]   = {0, 0, 0};
+    clock_event_t events[3];
+    uint64_t      now = clockevent.get_time();
+    // 到期时间分别为 4、2、3 个周期之后
+    for (size_t i = 0; i < 3; i++) {
+        events[i].handler = test_clockevent_handler;
+        events[i].data    = &fired[i];
+        events[i].pending = false;
+    }
+    events[0].expires = now + 4 * CLOCKEVENT::TICK_NS;
+    events[1].expires = now + 2 * CLOCKEVENT::TICK_NS;
+    events[2].expires = now + 3 * CLOCKEVENT::TICK_NS;
+    for (size_t i = 0; i < 3; i++) {
+        clockevent.add(&events[i]);
+    }
+    // 删除的事件不会执行
+    assert(clockevent.del(&events[2]) == true);
+    assert(clockevent.del(&events[2]) == false);
+    clockevent_order = 1;
+    while (events[0].pending == true) {
+        clockevent.wait_idle();
+    }
+    // 按到期时间执行
+    assert(fired[1] == 1);
+    assert(fired[0] == 2);
+    assert(fired[2] == 0);
+    assert(clockevent.get_time() >= events[0].expires);
+    info("clockevent test done.\n");
+    return 0;
+}
+
+/// 定时器执行的顺序
+static size_t timer_wheel_order;
+
+/**
+ * @brief 测试用的定时器，记录执行的顺序
+ * @param  _timer          定时器
+ */
+static void test_timer_wheel_function(timer_list_t *_timer) {
+    *(size_t *)_timer->data = timer_wheel_order++;
+    return;
+}
+
+int test_timer_wheel(void) {
+    TIMER_WHEEL &wheel    = TIMER_WHEEL::get_instance();
+    size_t       fired[4] = {0, 0, 0, 0};
+    size_t       count    = wheel.get_count();
+    timer_list_t timers[4];
+    for (size_t i = 0; i < 4; i++) {
+        TIMER_WHEEL::init_timer(&timers[i], test_timer_wheel_function,
+                                &fired[i]);
+    }
+    // 关中断，设置完成前定时器不会执行
+    CPU::DISABLE_INTR();
+    uint64_t now      = wheel.get_jiffies();
+    timers[0].expires = now + 3;
+    timers[1].expires = now + 1;
+    // 在第二级
+    timers[2].expires = now + 300;
+    timers[3].expires = now + 2;
+    for (size_t i = 0; i < 4; i++) {
+        wheel.add_timer(&timers[i]);
+    }
+    assert(wheel.get_count() == count + 4);
+    // 移到第一级
+    assert(wheel.mod_timer(&timers[2], now + 2) == true);
+    // 删除的定时器不会执行
+    assert(wheel.del_timer(&timers[3]) == true);
+    assert(wheel.del_timer(&timers[3]) == false);
+    assert(wheel.get_count() == count + 3);
+    timer_wheel_order = 1;
+    CPU::ENABLE_INTR();
+    while (timers[0].pprev != nullptr) {
+        CLOCKEVENT::get_instance().wait_idle();
+    }
+    // 按到期时间执行
+    assert(fired[1] == 1);
+    assert(fired[2] == 2);
+    assert(fired[0] == 3);
+    assert(fired[3] == 0);
+    assert(wheel.get_jiffies() >= now + 3);
+    assert(wheel.get_count() == count);
+    info("timer wheel test done.\n");
+    return 0;
+}
+
+/// 软中断执行的次数
+static size_t softirq_count;
+
+/**
+ * @brief 测试用的软中断
+ */
+static void test_softirq_action(void) {
+    softirq_count++;
+    return;
+}
+
+/**
+ * @brief 测试用的小任务，记录执行的次数
+ * @param  _tasklet        小任务
+ */
+static void test_tasklet_func(tasklet_t *_tasklet) {
+    (*(size_t *)_tasklet->data)++;
+    return;
+}
+
+int test_softirq(void) {
+    SOFTIRQ &softirq = SOFTIRQ::get_instance();
+    // 使用最后一个软中断号
+    softirq_count = 0;
+    softirq.open(SOFTIRQ::NR - 1, test_softirq_action);
+    softirq.raise(SOFTIRQ::NR - 1);
+    softirq.raise(SOFTIRQ::NR - 1);
+    softirq.run();
+    assert(softirq_count == 1);
+    softirq.open(SOFTIRQ::NR - 1, nullptr);
+    // 超过一轮的预算，分多轮执行完
+    size_t    count[40];
+    tasklet_t tasklets[40];
+    // 关中断，中断返回时不会提前执行已经调度的小任务
+    CPU::DISABLE_INTR();
+    for (size_t i = 0; i < 40; i++) {
+        count[i] = 0;
+        SOFTIRQ::init_tasklet(&tasklets[i], test_tasklet_func, &count[i]);
+        softirq.schedule(&tasklets[i]);
+    }
+    // 已经在队列中的不重复添加
+    softirq.schedule(&tasklets[0]);
+    CPU::ENABLE_INTR();
+    softirq.run();
+    for (size_t i = 0; i < 40; i++) {
+        assert(count[i] == 1);
+        assert(tasklets[i].scheduled == false);
+    }
+    assert((softirq.get_pending() & (1 << SOFTIRQ::TASKLET)) == 0);
+    info("softirq test done.\n");
+    return 0;
+}
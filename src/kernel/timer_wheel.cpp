@@ -0,0 +1,273 @@
+/**
+ * @file timer_wheel.cpp
+ * @brief 时间轮定时器实现
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#include "stdio.h"
+#include "cpu.hpp"
+#include "timer_wheel.h"
+
+TIMER_WHEEL::TIMER_WHEEL(void)
+    : jiffies(0), base(0), timer_jiffies(0), count(0), armed(UINT64_MAX) {
+    for (size_t i = 0; i < TVR_SIZE; i++) {
+        tv1[i] = nullptr;
+    }
+    for (size_t level = 0; level < TVN_LEVELS; level++) {
+        for (size_t i = 0; i < TVN_SIZE; i++) {
+            tvn[level][i] = nullptr;
+        }
+    }
+    event.expires = 0;
+    event.handler = event_handler;
+    event.data    = nullptr;
+    event.pending = false;
+    return;
+}
+
+TIMER_WHEEL::~TIMER_WHEEL(void) {
+    return;
+}
+
+void TIMER_WHEEL::init_timer(timer_list_t *_timer,
+                             void (*_function)(timer_list_t *), void *_data) {
+    _timer->expires  = 0;
+    _timer->function = _function;
+    _timer->data     = _data;
+    _timer->next     = nullptr;
+    _timer->pprev    = nullptr;
+    return;
+}
+
+TIMER_WHEEL &TIMER_WHEEL::get_instance(void) {
+    /// 定义全局 TIMER_WHEEL 对象
+    static TIMER_WHEEL timer_wheel;
+    return timer_wheel;
+}
+
+void TIMER_WHEEL::event_handler(clock_event_t *) {
+    TIMER_WHEEL &wheel = get_instance();
+    wheel.armed        = UINT64_MAX;
+    wheel.run();
+    uint64_t next = wheel.next_expiry();
+    if (next != UINT64_MAX) {
+        wheel.arm(next);
+    }
+    return;
+}
+
+void TIMER_WHEEL::update(void) {
+    // 空闲时没有周期时钟，按经过的时间补上
+    uint64_t now = CLOCKEVENT::get_instance().get_time();
+    while (now - base >= CLOCKEVENT::TICK_NS) {
+        base += CLOCKEVENT::TICK_NS;
+        jiffies++;
+    }
+    return;
+}
+
+void TIMER_WHEEL::internal_add(timer_list_t *_timer) {
+    uint64_t       expires = _timer->expires;
+    int64_t        idx     = (int64_t)(expires - timer_jiffies);
+    timer_list_t **slot    = nullptr;
+    if (idx < 0) {
+        // 已经到期，下一次处理
+        slot = &tv1[timer_jiffies & TVR_MASK];
+    }
+    else if ((uint64_t)idx < TVR_SIZE) {
+        slot = &tv1[expires & TVR_MASK];
+    }
+    else {
+        if ((uint64_t)idx > MAX_TIMEOUT) {
+            expires = timer_jiffies + MAX_TIMEOUT;
+            idx     = MAX_TIMEOUT;
+        }
+        // 找到能容纳的最低一级
+        size_t level = 0;
+        while ((uint64_t)idx >> (TVR_BITS + (level + 1) * TVN_BITS) != 0) {
+            level++;
+        }
+        slot = &tvn[level][(expires >> (TVR_BITS + level * TVN_BITS)) &
+                           TVN_MASK];
+    }
+    // 插入链表头
+    _timer->next = *slot;
+    if (*slot != nullptr) {
+        (*slot)->pprev = &_timer->next;
+    }
+    *slot         = _timer;
+    _timer->pprev = slot;
+    return;
+}
+
+void TIMER_WHEEL::detach(timer_list_t *_timer) {
+    *_timer->pprev = _timer->next;
+    if (_timer->next != nullptr) {
+        _timer->next->pprev = _timer->pprev;
+    }
+    _timer->next  = nullptr;
+    _timer->pprev = nullptr;
+    return;
+}
+
+size_t TIMER_WHEEL::cascade(size_t _level, size_t _index) {
+    // 先取出整个链表，重新分配时可能回到同一个槽
+    timer_list_t *head  = tvn[_level][_index];
+    tvn[_level][_index] = nullptr;
+    if (head != nullptr) {
+        head->pprev = &head;
+    }
+    while (head != nullptr) {
+        timer_list_t *timer = head;
+        detach(timer);
+        internal_add(timer);
+    }
+    return _index;
+}
+
+void TIMER_WHEEL::run(void) {
+    update();
+    // 没有定时器时直接跳到当前时间
+    if (count == 0) {
+        timer_jiffies = jiffies + 1;
+        return;
+    }
+    while (timer_jiffies <= jiffies) {
+        size_t index = timer_jiffies & TVR_MASK;
+        // 第一级转完一圈，从下一级补充，逐级向上
+        if (index == 0) {
+            for (size_t level = 0; level < TVN_LEVELS; level++) {
+                size_t shift = TVR_BITS + level * TVN_BITS;
+                if (cascade(level, (timer_jiffies >> shift) & TVN_MASK) !=
+                    0) {
+                    break;
+                }
+            }
+        }
+        timer_jiffies++;
+        // 先取出整个链表，定时器函数可能重新添加到同一个槽
+        timer_list_t *head = tv1[index];
+        tv1[index]         = nullptr;
+        if (head != nullptr) {
+            head->pprev = &head;
+        }
+        while (head != nullptr) {
+            timer_list_t *timer = head;
+            detach(timer);
+            count--;
+            timer->function(timer);
+        }
+    }
+    return;
+}
+
+uint64_t TIMER_WHEEL::next_expiry(void) const {
+    if (count == 0) {
+        return UINT64_MAX;
+    }
+    for (size_t i = 0; i < TVR_SIZE; i++) {
+        uint64_t j     = timer_jiffies + i;
+        size_t   index = j & TVR_MASK;
+        // 到达下一次重新分配时需要处理
+        if (index == 0 || tv1[index] != nullptr) {
+            return j;
+        }
+    }
+    return timer_jiffies + TVR_SIZE;
+}
+
+void TIMER_WHEEL::arm(uint64_t _jiffies) {
+    armed         = _jiffies;
+    event.expires = base;
+    if (_jiffies > jiffies) {
+        event.expires += (_jiffies - jiffies) * CLOCKEVENT::TICK_NS;
+    }
+    CLOCKEVENT::get_instance().add(&event);
+    return;
+}
+
+void TIMER_WHEEL::init(void) {
+    base          = CLOCKEVENT::get_instance().get_time();
+    jiffies       = 0;
+    timer_jiffies = 0;
+    info("timer wheel init.\n");
+    return;
+}
+
+uint64_t TIMER_WHEEL::get_jiffies(void) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    update();
+    uint64_t ret = jiffies;
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return ret;
+}
+
+void TIMER_WHEEL::add_timer(timer_list_t *_timer) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    update();
+    if (count == 0) {
+        timer_jiffies = jiffies + 1;
+    }
+    internal_add(_timer);
+    count++;
+    // 比已经设置的时钟早时重新设置
+    uint64_t expires = _timer->expires;
+    if (expires < timer_jiffies) {
+        expires = timer_jiffies;
+    }
+    if (expires < armed) {
+        arm(expires);
+    }
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return;
+}
+
+bool TIMER_WHEEL::mod_timer(timer_list_t *_timer, uint64_t _expires) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    bool pending    = del_timer(_timer);
+    _timer->expires = _expires;
+    add_timer(_timer);
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return pending;
+}
+
+bool TIMER_WHEEL::del_timer(timer_list_t *_timer) {
+    bool intr = CPU::STATUS_INTR();
+    CPU::DISABLE_INTR();
+    bool pending = _timer->pprev != nullptr;
+    if (pending == true) {
+        detach(_timer);
+        count--;
+        // 没有定时器时不再需要时钟
+        if (count == 0 && armed != UINT64_MAX) {
+            CLOCKEVENT::get_instance().del(&event);
+            armed = UINT64_MAX;
+        }
+    }
+    if (intr == true) {
+        CPU::ENABLE_INTR();
+    }
+    return pending;
+}
+
+size_t TIMER_WHEEL::get_count(void) const {
+    return count;
+}
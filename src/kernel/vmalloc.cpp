@@ -0,0 +1,126 @@
+/**
+ * @file vmalloc.cpp
+ * @brief 虚拟连续内存分配实现
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#include "stdio.h"
+#include "assert.h"
+#include "common.h"
+#include "firstfit.h"
+#include "pmm.h"
+#include "vmm.h"
+#include "vmalloc.h"
+
+VMALLOC &VMALLOC::get_instance(void) {
+    /// 定义全局 VMALLOC 对象
+    static VMALLOC vmalloc;
+    return vmalloc;
+}
+
+bool VMALLOC::init(void) {
+    static FIRSTFIT first_fit_allocator_vmalloc(
+        "First Fit Allocator(vmalloc)", VMALLOC_START,
+        VMALLOC_SIZE / COMMON::PAGE_SIZE);
+    allocator = (ALLOCATOR *)&first_fit_allocator_vmalloc;
+    // 位于内核高半部分，页表由所有页目录共享，映射不需要同步
+    pgd = VMM::get_instance().get_pgd();
+    info("vmalloc init.\n");
+    return true;
+}
+
+uintptr_t VMALLOC::alloc_area(size_t _pages) {
+    // 越界访问会落在保护页上
+    return allocator->alloc(_pages + 1);
+}
+
+void VMALLOC::free_frames(uintptr_t _va, size_t _pages) {
+    uintptr_t va  = _va;
+    uintptr_t end = _va + _pages * COMMON::PAGE_SIZE;
+    uintptr_t pa  = 0;
+    while (VMM::get_instance().next_mmap(pgd, va, end, &pa) == true) {
+        PMM::get_instance().free_page(pa);
+        va += COMMON::PAGE_SIZE;
+    }
+    return;
+}
+
+void *VMALLOC::vmalloc(size_t _len) {
+    size_t pages = COMMON::ALIGN(_len, COMMON::PAGE_SIZE) / COMMON::PAGE_SIZE;
+    if (pages == 0) {
+        return nullptr;
+    }
+    uintptr_t va = alloc_area(pages);
+    if (va == 0) {
+        return nullptr;
+    }
+    // 每次分配并映射一个页表能容纳的页
+    uintptr_t *frames = new uintptr_t[VMM_PAGES_PRE_PAGE_TABLE];
+    size_t     done   = 0;
+    while (done < pages) {
+        size_t count = pages - done;
+        if (count > VMM_PAGES_PRE_PAGE_TABLE) {
+            count = VMM_PAGES_PRE_PAGE_TABLE;
+        }
+        // 物理内存不足，释放已经映射的部分
+        if (PMM::get_instance().alloc_pages_bulk(frames, count) == false) {
+            free_frames(va, done);
+            VMM::get_instance().unmmap_range(pgd, va,
+                                             done * COMMON::PAGE_SIZE);
+            allocator->free(va, pages + 1);
+            delete[] frames;
+            return nullptr;
+        }
+        VMM::get_instance().mmap_pages(
+            pgd, va + done * COMMON::PAGE_SIZE, frames, count,
+            VMM_PAGE_READABLE | VMM_PAGE_WRITABLE | VMM_PAGE_GLOBAL);
+        done += count;
+    }
+    delete[] frames;
+    areas.emplace(va, area_t{pages, true});
+    return (void *)va;
+}
+
+void *VMALLOC::vmap(const uintptr_t *_pages, size_t _count, uint32_t _flag) {
+    if (_count == 0) {
+        return nullptr;
+    }
+    uintptr_t va = alloc_area(_count);
+    if (va == 0) {
+        return nullptr;
+    }
+    VMM::get_instance().mmap_pages(pgd, va, _pages, _count,
+                                   _flag | VMM_PAGE_GLOBAL);
+    areas.emplace(va, area_t{_count, false});
+    return (void *)va;
+}
+
+void VMALLOC::vfree(void *_addr) {
+    if (_addr == nullptr) {
+        return;
+    }
+    auto it = areas.find((uintptr_t)_addr);
+    // 不是 vmalloc/vmap 返回的地址
+    if (it == areas.end()) {
+        warn("VMALLOC::vfree: 0x%p not allocated.\n", _addr);
+        return;
+    }
+    uintptr_t va    = it->first;
+    size_t    pages = it->second.pages;
+    if (it->second.owned == true) {
+        free_frames(va, pages);
+    }
+    VMM::get_instance().unmmap_range(pgd, va, pages * COMMON::PAGE_SIZE);
+    allocator->free(va, pages + 1);
+    areas.erase(it);
+    return;
+}
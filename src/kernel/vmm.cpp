@@ -28,37 +28,57 @@
 // 在 _pgd 中查找 _va 对应的页表项
 // 如果未找到，_alloc 为真时会进行分配
 pte_t *VMM::find(const pt_t _pgd, uintptr_t _va, bool _alloc) {
+    size_t level = 0;
+    pte_t *pte   = find(_pgd, _va, _alloc, level);
+    // 只查找时可能返回大页，调用者需要的是 0 级页表项
+    if (level != 0) {
+        return nullptr;
+    }
+    return pte;
+}
+
+// 在 _pgd 中查找 _va 对应的第 _level 级页表项
+pte_t *VMM::find(const pt_t _pgd, uintptr_t _va, bool _alloc,
+                 size_t &_level) {
     pt_t pgd = _pgd;
     // sv39 共有三级页表，一级一级查找
-    // -1 是因为最后一级是具体的某一页，在函数最后直接返回
-    for (size_t level = VMM_PT_LEVEL - 1; level > 0; level--) {
+    // 到 _level 级为止，在函数最后直接返回
+    for (size_t level = VMM_PT_LEVEL - 1; level > _level; level--) {
         // 每次循环会找到 _va 的第 level 级页表 pgd
         // 相当于 pgd_level[VPN_level]，这样相当于得到了第 level 级页表的地址
         pte_t *pte = (pte_t *)&pgd[PX(level, _va)];
         // 解引用 pte，如果有效，获取 level+1 级页表，
         if ((*pte & VMM_PAGE_VALID) == 1) {
+            // 如果是大页
+            if (IS_LEAF(*pte, level) == true) {
+                // 只查找的话直接返回大页
+                if (_alloc == false) {
+                    _level = level;
+                    return pte;
+                }
+                // 否则拆分为下一级页表后继续
+                split(pte, level, _va);
+            }
             // pgd 指向下一级页表
-            // *pte 保存的是页表项，需要转换为对应的物理地址
-            pgd = (pt_t)PTE2PA(*pte);
+            // *pte 保存的是页表项，需要转换为直接映射区中的地址
+            pgd = PTE2PT(*pte);
         }
         // 如果无效
         else {
             // 判断是否需要分配
             // 如果需要
             if (_alloc == true) {
-                // 申请新的物理页
-                pgd = (pt_t)PMM::get_instance().alloc_page_kernel();
-                bzero(pgd, COMMON::PAGE_SIZE);
+                // 申请新的页表
+                pgd = alloc_pt();
                 // 申请失败则返回
                 if (pgd == nullptr) {
                     // 如果出现这种情况，说明物理内存不够，一般不会出现
                     assert(0);
                     return nullptr;
                 }
-                // 清零
-                bzero(pgd, COMMON::PAGE_SIZE);
                 // 填充页表项
-                *pte = PA2PTE((uintptr_t)pgd) | VMM_PAGE_VALID;
+                set_pte(pte, PT2PTE(pgd) | VMM_PAGE_TABLE);
+                pt_changed = true;
             }
             // 不分配的话直接返回
             else {
@@ -66,8 +86,166 @@ pte_t *VMM::find(const pt_t _pgd, uintptr_t _va, bool _alloc) {
             }
         }
     }
-    // 0 最低级 pt
-    return &pgd[PX(0, _va)];
+    return &pgd[PX(_level, _va)];
+}
+
+pt_t VMM::alloc_pt(void) {
+    uintptr_t pa = PMM::get_instance().alloc_page_kernel();
+    if (pa == 0) {
+        return nullptr;
+    }
+    // 页表通过直接映射区访问
+    pt_t pt = (pt_t)VMM_PA2VA(pa);
+    bzero(pt, COMMON::PAGE_SIZE);
+    count(pt) = 0;
+    return pt;
+}
+
+uint16_t &VMM::count(const pte_t *_pte) {
+    uintptr_t pt = (uintptr_t)_pte & COMMON::PAGE_MASK;
+    // 页表只会从内核空间分配
+    assert(pt >= COMMON::KERNEL_START_ADDR &&
+           pt < COMMON::KERNEL_START_ADDR + VMM_KERNEL_SPACE_SIZE);
+    return pt_count[(pt - COMMON::KERNEL_START_ADDR) / COMMON::PAGE_SIZE];
+}
+
+void VMM::set_pte(pte_t *_pte, pte_t _val) {
+    // 换出的页表项无效但仍在使用，页表不能被释放
+    bool old_used = *_pte != 0;
+    bool new_used = _val != 0;
+    if (old_used == false && new_used == true) {
+        count(_pte)++;
+    }
+    else if (old_used == true && new_used == false) {
+        count(_pte)--;
+    }
+    *_pte = _val;
+    return;
+}
+
+void VMM::reclaim(const pt_t _pgd, uintptr_t _va, size_t _level) {
+    // 记录从页目录到第 _level 级页表经过的页表项
+    pte_t *path[VMM_PT_LEVEL];
+    pt_t   pt = _pgd;
+    for (size_t level = VMM_PT_LEVEL - 1; level > _level; level--) {
+        path[level] = &pt[PX(level, _va)];
+        if ((*path[level] & VMM_PAGE_VALID) == 0 ||
+            IS_LEAF(*path[level], level) == true) {
+            return;
+        }
+        pt = PTE2PT(*path[level]);
+    }
+    // pt 为第 _level 级页表，为空的话释放，再检查上一级
+    for (size_t level = _level; level < VMM_PT_LEVEL - 1; level++) {
+        if (count(pt) != 0) {
+            break;
+        }
+        // 与内核共享的页表其它地址空间也在使用，不能释放
+        if (level + 1 == VMM_PT_LEVEL - 1 && shared(_pgd, _va) == true) {
+            break;
+        }
+        set_pte(path[level + 1], 0x00);
+        // 页表缓存中可能还有指向 pt 的项，释放前需要全部刷新
+        flush_all(_pgd, _va);
+        PMM::get_instance().free_page(VMM_VA2PA((uintptr_t)pt));
+        pt = (pt_t)((uintptr_t)path[level + 1] & COMMON::PAGE_MASK);
+    }
+    return;
+}
+
+pte_t *VMM::walk(walker_t &_walker, uintptr_t _va) {
+    uintptr_t base = _va & ~(PXSIZE(1) - 1);
+    // 还在当前页表中
+    if (_walker.pt != nullptr && _walker.base == base) {
+        return &_walker.pt[PX(0, _va)];
+    }
+    pte_t *pte   = find(_walker.pgd, _va, _walker.alloc);
+    _walker.pt   = nullptr;
+    _walker.base = base;
+    if (pte != nullptr) {
+        _walker.pt = (pt_t)(pte - PX(0, _va));
+    }
+    return pte;
+}
+
+void VMM::split(pte_t *_pte, size_t _level, uintptr_t _va) {
+    pt_t pt = alloc_pt();
+    assert(pt != nullptr);
+    // 大页的物理地址与属性
+    uintptr_t pa   = PTE2PA(*_pte) & ~(PXSIZE(_level) - 1);
+    pte_t     flag = (*_pte & ((1 << VMM_PTE_PROP_BITS) - 1)) & ~VMM_PAGE_HUGE;
+    // 下一级仍是大页的话需要保留大页标志
+    if (_level - 1 > 0) {
+        flag |= VMM_PAGE_HUGE;
+    }
+    for (size_t i = 0; i < VMM_PAGES_PRE_PAGE_TABLE; i++) {
+        pt[i] = PA2PTE(pa + i * PXSIZE(_level - 1)) | flag;
+    }
+    count(pt)  = VMM_PAGES_PRE_PAGE_TABLE;
+    *_pte      = PT2PTE(pt) | VMM_PAGE_TABLE;
+    pt_changed = true;
+    // 刷新大页的 TLB 项与页表缓存
+    CPU::VMM_FLUSH(_va);
+    return;
+}
+
+pte_t *VMM::next_pte(const pt_t _pgd, uintptr_t &_va, uintptr_t _end,
+                     size_t &_level) {
+    uintptr_t va = _va;
+    while (va < _end) {
+        pt_t   pt    = _pgd;
+        size_t level = VMM_PT_LEVEL - 1;
+        // 向下查找，直到遇到叶子或无效的页表项
+        while (true) {
+            pte_t *pte = &pt[PX(level, va)];
+            if ((*pte & VMM_PAGE_VALID) == 0) {
+                break;
+            }
+            if (IS_LEAF(*pte, level) == true) {
+                _va    = va;
+                _level = level;
+                return pte;
+            }
+            pt = PTE2PT(*pte);
+            level--;
+        }
+        // 第 level 级的页表项无效，它覆盖的地址都没有映射
+        uintptr_t next = (va & ~(PXSIZE(level) - 1)) + PXSIZE(level);
+        // 到达地址空间末尾
+        if (next <= va) {
+            break;
+        }
+        va = next;
+    }
+    return nullptr;
+}
+
+VMM::tlb_entry_t &VMM::tlb_entry(uintptr_t _va) {
+    return tlb[(_va >> VMM_PAGE_OFF_BITS) & (TLB_ENTRIES - 1)];
+}
+
+void VMM::tlb_invalidate(uintptr_t _va, size_t _len) {
+    size_t pages = _len / COMMON::PAGE_SIZE;
+    // 超过项数时每一项都可能受影响
+    if (pages >= TLB_ENTRIES) {
+        tlb_invalidate_all();
+        return;
+    }
+    for (size_t i = 0; i < pages; i++) {
+        uintptr_t    va    = _va + i * COMMON::PAGE_SIZE;
+        tlb_entry_t &entry = tlb_entry(va);
+        if (entry.va == (va & COMMON::PAGE_MASK)) {
+            entry.pgd = nullptr;
+        }
+    }
+    return;
+}
+
+void VMM::tlb_invalidate_all(void) {
+    for (size_t i = 0; i < TLB_ENTRIES; i++) {
+        tlb[i].pgd = nullptr;
+    }
+    return;
 }
 
 VMM &VMM::get_instance(void) {
@@ -80,17 +258,50 @@ bool VMM::init(void) {
 #if defined(__i386__) || defined(__x86_64__)
     GDT::init();
 #endif
-    // 分配一页用于保存页目录
-    pt_t pgd_kernel = (pt_t)PMM::get_instance().alloc_page_kernel();
-    bzero(pgd_kernel, COMMON::PAGE_SIZE);
-    // 映射内核空间
-    for (uintptr_t addr = (uintptr_t)COMMON::KERNEL_START_ADDR;
-         addr < (uintptr_t)COMMON::KERNEL_START_ADDR + VMM_KERNEL_SPACE_SIZE;
-         addr += COMMON::PAGE_SIZE) {
-        // TODO: 区分代码/数据等段分别映射
-        mmap(pgd_kernel, addr, addr,
-             VMM_PAGE_READABLE | VMM_PAGE_WRITABLE | VMM_PAGE_EXECUTABLE);
+    huge_level = VMM_HUGE_LEVEL;
+#if defined(__x86_64__)
+    // 1GB 页需要 CPU 支持
+    if (CPU::CPUID().pdpe1gb() == false) {
+        huge_level = 1;
     }
+#endif
+    kernel_shared = false;
+    tlb_invalidate_all();
+    // 分配一页用于保存页目录
+    pgd_kernel = alloc_pt();
+    assert(pgd_kernel != nullptr);
+    // 内核的映射在所有地址空间中都相同，设置全局位，切换地址空间时保留
+    // 直接映射所有物理内存，之后可以通过 VMM_PA2VA 访问任意物理页
+    // 对齐的部分使用大页，分配器返回的页不需要再映射
+    // 内核链接在直接映射区中，内核空间按段单独映射
+    uintptr_t start = PMM::get_instance().get_pmm_start();
+    uintptr_t end =
+        start + (PMM::get_instance().get_pmm_length() & COMMON::PAGE_MASK);
+    uintptr_t kernel     = VMM_VA2PA(COMMON::KERNEL_START_ADDR);
+    uintptr_t kernel_end = kernel + VMM_KERNEL_SPACE_SIZE;
+    assert(start <= kernel && kernel_end <= end);
+    mmap_range(pgd_kernel, VMM_PA2VA(start), start, kernel - start,
+               VMM_PAGE_READABLE | VMM_PAGE_WRITABLE | VMM_PAGE_GLOBAL);
+    mmap_range(pgd_kernel, VMM_PA2VA(kernel_end), kernel_end, end - kernel_end,
+               VMM_PAGE_READABLE | VMM_PAGE_WRITABLE | VMM_PAGE_GLOBAL);
+    // 代码段只读可执行，只读数据段只读
+    // 代码段之前的保留区域与数据段之后的部分可读写
+    uintptr_t text = COMMON::KERNEL_TEXT_START_ADDR & COMMON::PAGE_MASK;
+    uintptr_t rodata =
+        COMMON::ALIGN(COMMON::KERNEL_RODATA_START_ADDR, COMMON::PAGE_SIZE);
+    uintptr_t data =
+        COMMON::ALIGN(COMMON::KERNEL_DATA_START_ADDR, COMMON::PAGE_SIZE);
+    mmap_range(pgd_kernel, COMMON::KERNEL_START_ADDR, kernel,
+               text - COMMON::KERNEL_START_ADDR,
+               VMM_PAGE_READABLE | VMM_PAGE_WRITABLE | VMM_PAGE_GLOBAL);
+    mmap_range(pgd_kernel, text, VMM_VA2PA(text), rodata - text,
+               VMM_PAGE_READABLE | VMM_PAGE_EXECUTABLE | VMM_PAGE_GLOBAL);
+    mmap_range(pgd_kernel, rodata, VMM_VA2PA(rodata), data - rodata,
+               VMM_PAGE_READABLE | VMM_PAGE_GLOBAL);
+    mmap_range(pgd_kernel, data, VMM_VA2PA(data), VMM_PA2VA(kernel_end) - data,
+               VMM_PAGE_READABLE | VMM_PAGE_WRITABLE | VMM_PAGE_GLOBAL);
+    // 直接映射区已经可能使用了大页，之后再分配其余的页表
+    reserve_kernel_half();
     // 设置页目录
     set_pgd(pgd_kernel);
     // 开启分页
@@ -100,14 +311,65 @@ bool VMM::init(void) {
 }
 
 pt_t VMM::get_pgd(void) {
-    return (pt_t)CPU::GET_PGD();
+    // 低位可能保存着 ASID 等信息
+    return (pt_t)VMM_PA2VA(CPU::GET_PGD() & COMMON::PAGE_MASK);
 }
 
 void VMM::set_pgd(const pt_t _pgd) {
     // 设置页目录
-    CPU::SET_PGD((uintptr_t)_pgd);
+    CPU::SET_PGD(VMM_VA2PA((uintptr_t)_pgd));
     // 刷新缓存
-    CPU::VMM_FLUSH(0);
+    CPU::VMM_FLUSH_ALL();
+    tlb_invalidate_all();
+    return;
+}
+
+pt_t VMM::alloc_pgd(void) {
+    pt_t pgd = alloc_pt();
+    if (pgd == nullptr) {
+        return nullptr;
+    }
+    size_t half = PX(VMM_PT_LEVEL - 1, VMM_KERNEL_HALF_START);
+    // 复制内核高半部分的顶级页表项，下一级页表已经预先分配，由所有页目录共享
+    for (size_t i = half; i < VMM_PAGES_PRE_PAGE_TABLE; i++) {
+        set_pte(&pgd[i], pgd_kernel[i]);
+    }
+    kernel_shared = true;
+    return pgd;
+}
+
+void VMM::free_pt(pt_t _pt, size_t _level) {
+    // 非叶子的有效页表项指向下一级页表
+    if (_level > 0) {
+        for (size_t i = 0; i < VMM_PAGES_PRE_PAGE_TABLE; i++) {
+            if ((_pt[i] & VMM_PAGE_VALID) == VMM_PAGE_VALID &&
+                IS_LEAF(_pt[i], _level) == false) {
+                free_pt(PTE2PT(_pt[i]), _level - 1);
+            }
+        }
+    }
+    PMM::get_instance().free_page(VMM_VA2PA((uintptr_t)_pt));
+    return;
+}
+
+void VMM::free_pgd(pt_t _pgd) {
+    assert(_pgd != pgd_kernel);
+    assert(_pgd != get_pgd());
+    for (size_t i = 0; i < VMM_PAGES_PRE_PAGE_TABLE; i++) {
+        // 跳过与内核共享的页表
+        if ((_pgd[i] & VMM_PAGE_VALID) == 0 || _pgd[i] == pgd_kernel[i] ||
+            IS_LEAF(_pgd[i], VMM_PT_LEVEL - 1) == true) {
+            continue;
+        }
+        free_pt(PTE2PT(_pgd[i]), VMM_PT_LEVEL - 2);
+    }
+    // 页目录可能被重新分配，软件 TLB 中属于它的项失效
+    for (size_t i = 0; i < TLB_ENTRIES; i++) {
+        if (tlb[i].pgd == _pgd) {
+            tlb[i].pgd = nullptr;
+        }
+    }
+    PMM::get_instance().free_page(VMM_VA2PA((uintptr_t)_pgd));
     return;
 }
 
@@ -124,15 +386,142 @@ void VMM::mmap(const pt_t _pgd, uintptr_t _va, uintptr_t _pa, uint32_t _flag) {
     else {
         // 那么设置 *pte
         // pte 解引用后的值是页表项
-        *pte = PA2PTE(_pa) | _flag | VMM_PAGE_VALID;
+        set_pte(pte, PA2PTE(_pa) | _flag | VMM_PAGE_VALID);
         // 刷新缓存
-        CPU::VMM_FLUSH((uintptr_t)_va);
+        flush_range(_pgd, _va, COMMON::PAGE_SIZE);
+    }
+    return;
+}
+
+bool VMM::shared(const pt_t _pgd, uintptr_t _va) {
+    if (kernel_shared == false) {
+        return false;
+    }
+    if (_pgd == pgd_kernel) {
+        return true;
+    }
+    size_t idx = PX(VMM_PT_LEVEL - 1, _va);
+    return ((_pgd[idx] & VMM_PAGE_VALID) == VMM_PAGE_VALID) &&
+           (_pgd[idx] == pgd_kernel[idx]);
+}
+
+void VMM::flush_all(const pt_t _pgd, uintptr_t _va) {
+    // 内核页目录中的映射可能是全局页，重新加载页目录不会刷新
+    if (_pgd == pgd_kernel || shared(_pgd, _va) == true) {
+        CPU::VMM_FLUSH_ALL_ASID();
+    }
+    else {
+        CPU::VMM_FLUSH_ALL();
+    }
+    return;
+}
+
+void VMM::flush_range(const pt_t _pgd, uintptr_t _va, size_t _len) {
+    // 修改映射后都会调用，同时使软件 TLB 失效
+    tlb_invalidate(_va, _len);
+    size_t pages = _len / COMMON::PAGE_SIZE;
+    // 页数较多时逐页刷新比全部刷新更慢
+    if (pages > FLUSH_ALL_PAGES || pt_changed == true) {
+        flush_all(_pgd, _va);
+        pt_changed = false;
+    }
+#if defined(__x86_64__)
+    // invlpg 只刷新当前 PCID，共享的映射可能还缓存在其它 PCID 中
+    // 内核高半部分的映射都是全局页，invlpg 会一并刷新
+    else if (_va < VMM_KERNEL_HALF_START && shared(_pgd, _va) == true) {
+        CPU::VMM_FLUSH_ALL_ASID();
+    }
+#endif
+    else {
+        for (size_t i = 0; i < pages; i++) {
+            CPU::VMM_FLUSH(_va + i * COMMON::PAGE_SIZE);
+        }
+    }
+    return;
+}
+
+void VMM::mmap_range(const pt_t _pgd, uintptr_t _va, uintptr_t _pa,
+                     size_t _len, uint32_t _flag) {
+    uintptr_t va     = _va;
+    uintptr_t pa     = _pa;
+    uintptr_t end    = _va + _len;
+    walker_t  walker = {_pgd, true, nullptr, 0};
+    while (va < end) {
+        // 找出 va、pa 与剩余长度都对齐的最大页
+        size_t level = huge_level;
+        for (; level > 0; level--) {
+            size_t size = PXSIZE(level);
+            if (((va | pa) & (size - 1)) == 0 && end - va >= size) {
+                size_t found = level;
+                pte_t *pte   = find(_pgd, va, true, found);
+                // 已经有下一级页表的话，使用更小的页
+                if ((*pte & VMM_PAGE_VALID) == VMM_PAGE_VALID &&
+                    IS_LEAF(*pte, level) == false) {
+                    continue;
+                }
+                set_pte(pte,
+                        PA2PTE(pa) | _flag | VMM_PAGE_HUGE | VMM_PAGE_VALID);
+                walker.pt = nullptr;
+                break;
+            }
+        }
+        if (level == 0) {
+            // 进入新的页表时才需要查找
+            pte_t *pte = walk(walker, va);
+            assert(pte != nullptr);
+            set_pte(pte, PA2PTE(pa) | _flag | VMM_PAGE_VALID);
+        }
+        va += PXSIZE(level);
+        pa += PXSIZE(level);
     }
+    // 统一刷新缓存
+    flush_range(_pgd, _va, _len);
+    return;
+}
+
+void VMM::reserve_kernel_half(void) {
+    // 已有的页目录不会看到新的顶级页表项
+    assert(kernel_shared == false);
+    size_t top = VMM_PT_LEVEL - 1;
+    // 到达地址空间末尾时回绕为 0
+    for (uintptr_t va = VMM_KERNEL_HALF_START; va >= VMM_KERNEL_HALF_START;
+         va += PXSIZE(top)) {
+        // 直接映射区的顶级大页不会被修改，不需要拆分
+        pte_t entry = pgd_kernel[PX(top, va)];
+        if ((entry & VMM_PAGE_VALID) == VMM_PAGE_VALID &&
+            IS_LEAF(entry, top) == true) {
+            continue;
+        }
+        size_t level = top - 1;
+        pte_t *pte   = find(pgd_kernel, va, true, level);
+        assert(pte != nullptr);
+        // 多计一项，页表不会因为变空而被释放
+        count(pte)++;
+    }
+    return;
+}
+
+void VMM::mmap_pages(const pt_t _pgd, uintptr_t _va, const uintptr_t *_pages,
+                     size_t _count, uint32_t _flag) {
+    // 进入新的页表时才需要查找
+    walker_t walker = {_pgd, true, nullptr, 0};
+    for (size_t i = 0; i < _count; i++) {
+        pte_t *pte = walk(walker, _va + i * COMMON::PAGE_SIZE);
+        assert(pte != nullptr);
+        set_pte(pte, PA2PTE(_pages[i]) | _flag | VMM_PAGE_VALID);
+    }
+    // 统一刷新缓存
+    flush_range(_pgd, _va, _count * COMMON::PAGE_SIZE);
     return;
 }
 
 void VMM::unmmap(const pt_t _pgd, uintptr_t _va) {
-    pte_t *pte = find(_pgd, _va, false);
+    size_t level = 0;
+    pte_t *pte   = find(_pgd, _va, false, level);
+    // 位于大页中，先拆分
+    if (pte != nullptr && level != 0) {
+        pte = find(_pgd, _va, true);
+    }
     // 找到页表项
     // 未找到
     if (pte == nullptr) {
@@ -144,24 +533,84 @@ void VMM::unmmap(const pt_t _pgd, uintptr_t _va) {
         warn("VMM::unmmap: not mapped.\n");
     }
     // 置零
-    *pte = 0x00;
+    set_pte(pte, 0x00);
     // 刷新缓存
-    CPU::VMM_FLUSH((uintptr_t)_va);
-    // TODO: 如果一页表都被 unmap，释放占用的物理内存
+    flush_range(_pgd, _va, COMMON::PAGE_SIZE);
+    // 如果整个页表都被 unmap，释放占用的物理内存
+    if (count(pte) == 0) {
+        reclaim(_pgd, _va, 0);
+    }
+    return;
+}
+
+void VMM::unmmap_range(const pt_t _pgd, uintptr_t _va, size_t _len) {
+    uintptr_t va     = _va;
+    uintptr_t end    = _va + _len;
+    walker_t  walker = {_pgd, false, nullptr, 0};
+    while (va < end) {
+        pte_t *pte = walk(walker, va);
+        if (pte == nullptr) {
+            size_t level = 0;
+            pte          = find(_pgd, va, false, level);
+            // 没有页表，跳到下一个页表的范围
+            if (pte == nullptr) {
+                va = (va & ~(PXSIZE(1) - 1)) + PXSIZE(1);
+                continue;
+            }
+            // 位于大页中，整个大页都要取消映射的话直接清除
+            if ((va & (PXSIZE(level) - 1)) == 0 &&
+                end - va >= PXSIZE(level)) {
+                set_pte(pte, 0x00);
+                if (count(pte) == 0) {
+                    reclaim(_pgd, va, level);
+                }
+                va += PXSIZE(level);
+                continue;
+            }
+            // 否则拆分后重新查找
+            find(_pgd, va, true);
+            pte = walk(walker, va);
+        }
+        set_pte(pte, 0x00);
+        // 整个页表都被 unmap 的话释放，之后的地址需要重新查找
+        if (count(pte) == 0) {
+            reclaim(_pgd, va, 0);
+            walker.pt = nullptr;
+        }
+        va += COMMON::PAGE_SIZE;
+    }
+    // 统一刷新缓存
+    flush_range(_pgd, _va, _len);
     return;
 }
 
 bool VMM::get_mmap(const pt_t _pgd, uintptr_t _va, const void *_pa) {
-    pte_t *pte = find(_pgd, _va, false);
-    bool   res = false;
+    // 先查找软件 TLB
+    tlb_entry_t &entry = tlb_entry(_va);
+    if (entry.pgd == _pgd && entry.va == (_va & COMMON::PAGE_MASK)) {
+        if (_pa != nullptr) {
+            *(uintptr_t *)_pa = entry.pa;
+        }
+        return true;
+    }
+    size_t level = 0;
+    pte_t *pte   = find(_pgd, _va, false, level);
+    bool   res   = false;
     // pte 不为空且有效，说明映射了
     if ((pte != nullptr) && ((*pte & VMM_PAGE_VALID) == 1)) {
+        // 将页表项转换为物理地址，大页需要加上 _va 所在页的偏移
+        uintptr_t base = PTE2PA(*pte) & ~(PXSIZE(level) - 1);
+        uintptr_t pa =
+            base + ((_va & (PXSIZE(level) - 1)) & COMMON::PAGE_MASK);
         // 如果 _pa 不为空
         if (_pa != nullptr) {
             // 设置 _pa
-            // 将页表项转换为物理地址
-            *(uintptr_t *)_pa = PTE2PA(*pte);
+            *(uintptr_t *)_pa = pa;
         }
+        // 填充软件 TLB
+        entry.pgd = _pgd;
+        entry.va  = _va & COMMON::PAGE_MASK;
+        entry.pa  = pa;
         // 返回 true
         res = true;
     }
@@ -175,3 +624,189 @@ bool VMM::get_mmap(const pt_t _pgd, uintptr_t _va, const void *_pa) {
     }
     return res;
 }
+
+bool VMM::next_mmap(const pt_t _pgd, uintptr_t &_va, uintptr_t _end,
+                    const void *_pa) {
+    size_t level = 0;
+    pte_t *pte   = next_pte(_pgd, _va, _end, level);
+    if (pte == nullptr) {
+        return false;
+    }
+    // 大页需要加上 _va 所在页的偏移
+    uintptr_t base = PTE2PA(*pte) & ~(PXSIZE(level) - 1);
+    *(uintptr_t *)_pa =
+        base + ((_va & (PXSIZE(level) - 1)) & COMMON::PAGE_MASK);
+    return true;
+}
+
+size_t VMM::get_mmap_sg(const pt_t _pgd, uintptr_t _va, size_t _len,
+                        vmm_sg_t *_sg, size_t _count) {
+    uintptr_t va     = _va;
+    uintptr_t end    = _va + _len;
+    size_t    n      = 0;
+    walker_t  walker = {_pgd, false, nullptr, 0};
+    while (va < end) {
+        size_t level = 0;
+        pte_t *pte   = walk(walker, va);
+        // 没有页表或位于大页中
+        if (pte == nullptr) {
+            pte = find(_pgd, va, false, level);
+        }
+        // 有未映射的地址
+        if (pte == nullptr || (*pte & VMM_PAGE_VALID) == 0) {
+            return 0;
+        }
+        // 这一页(或大页)中剩余的部分
+        size_t    size = PXSIZE(level);
+        uintptr_t pa   = (PTE2PA(*pte) & ~(size - 1)) + (va & (size - 1));
+        size_t    len  = size - (va & (size - 1));
+        if (len > end - va) {
+            len = end - va;
+        }
+        // 与上一段物理地址连续则合并
+        if (n != 0 && _sg[n - 1].pa + _sg[n - 1].len == pa) {
+            _sg[n - 1].len += len;
+        }
+        else {
+            if (n == _count) {
+                return 0;
+            }
+            _sg[n].pa  = pa;
+            _sg[n].len = len;
+            n++;
+        }
+        va += len;
+    }
+    return n;
+}
+
+void VMM::protect_range(const pt_t _pgd, uintptr_t _va, size_t _len,
+                        uint32_t _flag) {
+    uintptr_t va    = _va;
+    uintptr_t end   = _va + _len;
+    size_t    level = 0;
+    pte_t *   pte   = nullptr;
+    while ((pte = next_pte(_pgd, va, end, level)) != nullptr) {
+        pte_t huge = 0;
+        if (level != 0) {
+            // 大页只有一部分在范围内，拆分后只修改范围内的页
+            if ((va & (PXSIZE(level) - 1)) != 0 || end - va < PXSIZE(level)) {
+                pte   = find(_pgd, va, true);
+                level = 0;
+            }
+            else {
+                huge = VMM_PAGE_HUGE;
+            }
+        }
+        // 保留 CPU 设置的已使用位与已修改位，替换算法需要
+        *pte = PA2PTE(PTE2PA(*pte)) |
+               (*pte & (VMM_PAGE_ACCESSED | VMM_PAGE_DIRTY)) | _flag | huge |
+               VMM_PAGE_VALID;
+        va += PXSIZE(level);
+    }
+    // 统一刷新缓存
+    flush_range(_pgd, _va, _len);
+    return;
+}
+
+bool VMM::test_and_clear_accessed(const pt_t _pgd, uintptr_t _va) {
+    size_t level = 0;
+    pte_t *pte   = find(_pgd, _va, false, level);
+    if (pte == nullptr || (*pte & VMM_PAGE_VALID) == 0 ||
+        (*pte & VMM_PAGE_ACCESSED) == 0) {
+        return false;
+    }
+    *pte &= ~(pte_t)VMM_PAGE_ACCESSED;
+    // 大页需要刷新整个大页
+    uintptr_t va = _va & ~(PXSIZE(level) - 1);
+    flush_range(_pgd, va, PXSIZE(level));
+    return true;
+}
+
+bool VMM::is_dirty(const pt_t _pgd, uintptr_t _va) {
+    size_t level = 0;
+    pte_t *pte   = find(_pgd, _va, false, level);
+    if (pte == nullptr || (*pte & VMM_PAGE_VALID) == 0) {
+        return false;
+    }
+    return (*pte & VMM_PAGE_DIRTY) != 0;
+}
+
+void VMM::set_swap(const pt_t _pgd, uintptr_t _va, uintptr_t _entry) {
+    assert(_entry != 0);
+    pte_t *pte = find(_pgd, _va, true);
+    assert(pte != nullptr);
+    set_pte(pte, VMM_SWAP2PTE(_entry));
+    flush_range(_pgd, _va & COMMON::PAGE_MASK, COMMON::PAGE_SIZE);
+    return;
+}
+
+bool VMM::get_swap(const pt_t _pgd, uintptr_t _va, uintptr_t *_entry) {
+    pte_t *pte = find(_pgd, _va, false);
+    if (pte == nullptr || *pte == 0 || (*pte & VMM_PAGE_VALID) != 0) {
+        return false;
+    }
+    *_entry = VMM_PTE2SWAP(*pte);
+    return true;
+}
+
+bool VMM::next_swap(const pt_t _pgd, uintptr_t &_va, uintptr_t _end,
+                    uintptr_t *_entry) {
+    walker_t  walker = {_pgd, false, nullptr, 0};
+    uintptr_t va     = _va;
+    while (va < _end) {
+        pte_t *pte = walk(walker, va);
+        // 没有页表或位于大页中，跳到下一个页表的范围
+        if (pte == nullptr) {
+            va = (va & ~(PXSIZE(1) - 1)) + PXSIZE(1);
+            continue;
+        }
+        if (*pte != 0 && (*pte & VMM_PAGE_VALID) == 0) {
+            _va     = va;
+            *_entry = VMM_PTE2SWAP(*pte);
+            return true;
+        }
+        va += COMMON::PAGE_SIZE;
+    }
+    return false;
+}
+
+size_t VMM::get_huge_size(void) const {
+    if (huge_level == 0) {
+        return 0;
+    }
+    return PXSIZE(1);
+}
+
+bool VMM::collapse_huge(const pt_t _pgd, uintptr_t _va, uintptr_t _pa,
+                        uint32_t _flag) {
+    if (huge_level == 0) {
+        return false;
+    }
+    assert((_va & (PXSIZE(1) - 1)) == 0 && (_pa & (PXSIZE(1) - 1)) == 0);
+    size_t level = 1;
+    pte_t *pte   = find(_pgd, _va, true, level);
+    assert(pte != nullptr && level == 1);
+    // 释放原来的页表，之后由一个页表项映射整个范围
+    if ((*pte & VMM_PAGE_VALID) == VMM_PAGE_VALID &&
+        IS_LEAF(*pte, 1) == false) {
+        free_pt(PTE2PT(*pte), 0);
+        pt_changed = true;
+    }
+    set_pte(pte, PA2PTE(_pa) | _flag | VMM_PAGE_HUGE | VMM_PAGE_VALID);
+    flush_range(_pgd, _va, PXSIZE(1));
+    return true;
+}
+
+bool VMM::split_huge(const pt_t _pgd, uintptr_t _va) {
+    size_t level = 0;
+    pte_t *pte   = find(_pgd, _va, false, level);
+    if (pte == nullptr || level == 0 || (*pte & VMM_PAGE_VALID) == 0) {
+        return false;
+    }
+    // 需要分配时 find 会逐级拆分途中的大页
+    level = 0;
+    pte   = find(_pgd, _va, true, level);
+    assert(pte != nullptr && level == 0);
+    return true;
+}
@@ -0,0 +1,292 @@
+/**
+ * @file zram.cpp
+ * @brief 压缩页存储实现
+ * @author Zone.N (Zone.Niuzh@hotmail.com)
+ * @version 1.0
+ * @date 2026-10-19
+ * @copyright MIT LICENSE
+ * https://github.com/Simple-XX/SimpleKernel
+ * @par change log:
+ * <table>
+ * <tr><th>Date<th>Author<th>Description
+ * <tr><td>2026-10-19<td>MRNIU<td>新增文件
+ * </table>
+ */
+
+#include "string.h"
+#include "assert.h"
+#include "common.h"
+#include "pmm.h"
+#include "vmm.h"
+#include "zram.h"
+
+ZRAM::ZRAM(void) : stored(0), compressed(0), rejected(0) {
+    return;
+}
+
+ZRAM &ZRAM::get_instance(void) {
+    /// 定义全局 ZRAM 对象
+    static ZRAM zram;
+    return zram;
+}
+
+void ZRAM::lz4_write_len(uint8_t *_dst, size_t &_out, size_t _n) {
+    for (; _n >= 255; _n -= 255) {
+        _dst[_out++] = 255;
+    }
+    _dst[_out++] = (uint8_t)_n;
+    return;
+}
+
+bool ZRAM::lz4_read_len(const uint8_t *_src, size_t _len, size_t &_in,
+                        size_t &_n) {
+    uint8_t b = 0;
+    do {
+        if (_in >= _len) {
+            return false;
+        }
+        b = _src[_in++];
+        _n += b;
+    } while (b == 255);
+    return true;
+}
+
+bool ZRAM::lz4_emit(uint8_t *_dst, size_t _cap, size_t &_out,
+                    const uint8_t *_lit, size_t _lit_len, size_t _offset,
+                    size_t _match) {
+    // 长度超过 15 时每多 255 需要一个字节
+    size_t need = 1 + _lit_len / 255 + 1 + _lit_len + 2 + _match / 255 + 1;
+    if (_out + need > _cap) {
+        return false;
+    }
+    size_t ml    = _match == 0 ? 0 : _match - LZ4_MIN_MATCH;
+    _dst[_out++] = (uint8_t)(((_lit_len < 15 ? _lit_len : 15) << 4) |
+                             (ml < 15 ? ml : 15));
+    if (_lit_len >= 15) {
+        lz4_write_len(_dst, _out, _lit_len - 15);
+    }
+    memcpy(_dst + _out, _lit, _lit_len);
+    _out += _lit_len;
+    // 最后的字面量之后没有匹配
+    if (_match == 0) {
+        return true;
+    }
+    _dst[_out++] = (uint8_t)(_offset & 0xFF);
+    _dst[_out++] = (uint8_t)(_offset >> 8);
+    if (ml >= 15) {
+        lz4_write_len(_dst, _out, ml - 15);
+    }
+    return true;
+}
+
+size_t ZRAM::lz4_compress(const uint8_t *_src, size_t _len, uint8_t *_dst,
+                          size_t _cap) {
+    size_t anchor = 0;
+    size_t pos    = 0;
+    size_t out    = 0;
+    bzero(hash_table, sizeof(hash_table));
+    // 最后 LZ4_MFLIMIT 字节中不能开始匹配
+    while (_len >= LZ4_MFLIMIT && pos <= _len - LZ4_MFLIMIT) {
+        uint32_t seq  = 0;
+        uint32_t cand = 0;
+        memcpy(&seq, _src + pos, sizeof(seq));
+        size_t h      = (seq * 2654435761U) >> (32 - LZ4_HASH_BITS);
+        size_t ref    = hash_table[h];
+        hash_table[h] = (uint16_t)(pos + 1);
+        if (ref != 0) {
+            memcpy(&cand, _src + ref - 1, sizeof(cand));
+        }
+        // 输入不超过一页，距离不会超过 16 位
+        if (ref == 0 || cand != seq) {
+            pos++;
+            continue;
+        }
+        ref--;
+        // 向后扩展匹配，最后 LZ4_LAST_LITERALS 字节必须是字面量
+        size_t match = LZ4_MIN_MATCH;
+        while (pos + match < _len - LZ4_LAST_LITERALS &&
+               _src[ref + match] == _src[pos + match]) {
+            match++;
+        }
+        if (lz4_emit(_dst, _cap, out, _src + anchor, pos - anchor, pos - ref,
+                     match) == false) {
+            return 0;
+        }
+        pos += match;
+        anchor = pos;
+    }
+    if (lz4_emit(_dst, _cap, out, _src + anchor, _len - anchor, 0, 0) ==
+        false) {
+        return 0;
+    }
+    return out;
+}
+
+bool ZRAM::lz4_decompress(const uint8_t *_src, size_t _len, uint8_t *_dst,
+                          size_t _cap) {
+    size_t in  = 0;
+    size_t out = 0;
+    while (in < _len) {
+        uint8_t token = _src[in++];
+        size_t  lit   = token >> 4;
+        if (lit == 15 && lz4_read_len(_src, _len, in, lit) == false) {
+            return false;
+        }
+        if (lit > _len - in || lit > _cap - out) {
+            return false;
+        }
+        memcpy(_dst + out, _src + in, lit);
+        in += lit;
+        out += lit;
+        // 最后一个序列只有字面量
+        if (in == _len) {
+            break;
+        }
+        if (_len - in < 2) {
+            return false;
+        }
+        size_t offset = _src[in] | (_src[in + 1] << 8);
+        in += 2;
+        if (offset == 0 || offset > out) {
+            return false;
+        }
+        size_t match = token & 0xF;
+        if (match == 15 && lz4_read_len(_src, _len, in, match) == false) {
+            return false;
+        }
+        match += LZ4_MIN_MATCH;
+        if (match > _cap - out) {
+            return false;
+        }
+        // 匹配可能与输出重叠，逐字节复制
+        for (size_t i = 0; i < match; i++) {
+            _dst[out + i] = _dst[out - offset + i];
+        }
+        out += match;
+    }
+    return out == _cap;
+}
+
+uintptr_t ZRAM::alloc_slot(size_t _size) {
+    auto &    part = partial[_size / SLOT_ALIGN - 1];
+    uintptr_t page = 0;
+    if (part.empty() == true) {
+        page = PMM::get_instance().alloc_page();
+        if (page == 0) {
+            return 0;
+        }
+        // 划分为槽，串成空闲链表
+        size_t n = COMMON::PAGE_SIZE / _size;
+        for (size_t i = 0; i < n; i++) {
+            slot_t *slot = (slot_t *)(VMM_PA2VA(page) + i * _size);
+            slot->len    = i + 1 < n ? (uint16_t)(i + 1) : FREE_END;
+            slot->refs   = 0;
+        }
+        zpages.emplace(page, zpage_t{_size, 0, 0});
+        part.insert(page);
+    }
+    else {
+        page = *part.begin();
+    }
+    zpage_t &zpage = zpages.find(page)->second;
+    uint16_t idx   = zpage.free;
+    slot_t * slot  = (slot_t *)(VMM_PA2VA(page) + idx * _size);
+    zpage.free     = slot->len;
+    zpage.used++;
+    // 没有空闲槽了
+    if (zpage.free == FREE_END) {
+        part.erase(page);
+    }
+    // 槽号小于一页中的槽数，保存在低位
+    return page | idx;
+}
+
+ZRAM::slot_t *ZRAM::get_slot(uintptr_t _entry) {
+    uintptr_t page = _entry & COMMON::PAGE_MASK;
+    auto      it   = zpages.find(page);
+    assert(it != zpages.end());
+    return (slot_t *)(VMM_PA2VA(page) +
+                      (_entry & ~COMMON::PAGE_MASK) * it->second.size);
+}
+
+uintptr_t ZRAM::store(const void *_page) {
+    size_t len =
+        lz4_compress((const uint8_t *)_page, COMMON::PAGE_SIZE, buf, MAX_LEN);
+    if (len == 0) {
+        rejected++;
+        return 0;
+    }
+    size_t size = (len + sizeof(slot_t) + SLOT_ALIGN - 1) / SLOT_ALIGN *
+                  SLOT_ALIGN;
+    uintptr_t entry = alloc_slot(size);
+    if (entry == 0) {
+        return 0;
+    }
+    slot_t *slot = get_slot(entry);
+    slot->len    = (uint16_t)len;
+    slot->refs   = 1;
+    memcpy(slot + 1, buf, len);
+    stored++;
+    compressed += len;
+    return entry;
+}
+
+void ZRAM::load(uintptr_t _entry, void *_page) {
+    slot_t *slot = get_slot(_entry);
+    assert(slot->refs != 0);
+    bool ret = lz4_decompress((const uint8_t *)(slot + 1), slot->len,
+                              (uint8_t *)_page, COMMON::PAGE_SIZE);
+    assert(ret == true);
+    (void)ret;
+    return;
+}
+
+void ZRAM::ref(uintptr_t _entry) {
+    slot_t *slot = get_slot(_entry);
+    assert(slot->refs != 0);
+    slot->refs++;
+    return;
+}
+
+void ZRAM::free(uintptr_t _entry) {
+    uintptr_t page = _entry & COMMON::PAGE_MASK;
+    uint16_t  idx  = (uint16_t)(_entry & ~COMMON::PAGE_MASK);
+    slot_t *  slot = get_slot(_entry);
+    assert(slot->refs != 0);
+    if (--slot->refs != 0) {
+        return;
+    }
+    stored--;
+    compressed -= slot->len;
+    zpage_t &zpage = zpages.find(page)->second;
+    auto &   part  = partial[zpage.size / SLOT_ALIGN - 1];
+    slot->len      = zpage.free;
+    zpage.free     = idx;
+    zpage.used--;
+    // 全部空闲，归还物理页
+    if (zpage.used == 0) {
+        part.erase(page);
+        zpages.erase(page);
+        PMM::get_instance().free_page(page);
+    }
+    else {
+        part.insert(page);
+    }
+    return;
+}
+
+size_t ZRAM::get_stored(void) const {
+    return stored;
+}
+
+size_t ZRAM::get_pool_pages(void) const {
+    return zpages.size();
+}
+
+size_t ZRAM::get_compressed(void) const {
+    return compressed;
+}
+
+size_t ZRAM::get_rejected(void) const {
+    return rejected;
+}
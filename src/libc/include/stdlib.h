@@ -26,6 +26,8 @@ void *malloc(size_t size);
 
 void free(void *ptr);
 
+void free_sized(void *ptr, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
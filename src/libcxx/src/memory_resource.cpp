@@ -0,0 +1,305 @@
+
+// This file is a part of Simple-XX/SimpleKernel
+// (https://github.com/Simple-XX/SimpleKernel).
+//
+// memory_resource.cpp for Simple-XX/SimpleKernel.
+
+#include "stddef.h"
+#include "stdint.h"
+#include "new"
+#include "memory_resource"
+
+namespace mystl {
+    namespace pmr {
+        // 将 _p 向上对齐到 _align，_align 为 2 的幂
+        static inline uintptr_t align_up(uintptr_t _p, size_t _align) {
+            return (_p + _align - 1) & ~(uintptr_t)(_align - 1);
+        }
+
+        memory_resource::~memory_resource(void) {
+            return;
+        }
+
+        // 直接使用 ::operator new/delete
+        // 堆只保证 max_align 对齐，更严格的对齐需要多申请并自行对齐，
+        // 原始地址保存在返回地址之前，释放时取回
+        class new_delete_resource_t : public memory_resource {
+        private:
+            static size_t padded(size_t _bytes, size_t _align) {
+                return _bytes + _align - 1 + sizeof(void *);
+            }
+
+            void *do_allocate(size_t _bytes, size_t _align) override {
+                if (_align <= max_align) {
+                    return ::operator new(_bytes);
+                }
+                void *raw = ::operator new(padded(_bytes, _align));
+                if (raw == nullptr) {
+                    return nullptr;
+                }
+                void **p =
+                    (void **)align_up((uintptr_t)raw + sizeof(void *), _align);
+                p[-1] = raw;
+                return p;
+            }
+
+            void do_deallocate(void *_p, size_t _bytes,
+                               size_t _align) override {
+                if (_align <= max_align) {
+                    ::operator delete(_p, _bytes);
+                    return;
+                }
+                ::operator delete(((void **)_p)[-1], padded(_bytes, _align));
+                return;
+            }
+
+            bool do_is_equal(const memory_resource &_other) const
+                noexcept override {
+                return this == &_other;
+            }
+        };
+
+        // 所有分配都返回 nullptr
+        class null_memory_resource_t : public memory_resource {
+        private:
+            void *do_allocate(size_t, size_t) override {
+                return nullptr;
+            }
+
+            void do_deallocate(void *, size_t, size_t) override {
+                return;
+            }
+
+            bool do_is_equal(const memory_resource &_other) const
+                noexcept override {
+                return this == &_other;
+            }
+        };
+
+        static new_delete_resource_t  new_delete_res;
+        static null_memory_resource_t null_res;
+        static memory_resource *      default_res = &new_delete_res;
+
+        memory_resource *new_delete_resource(void) noexcept {
+            return &new_delete_res;
+        }
+
+        memory_resource *null_memory_resource(void) noexcept {
+            return &null_res;
+        }
+
+        memory_resource *set_default_resource(memory_resource *_r) noexcept {
+            memory_resource *old = default_res;
+            default_res          = (_r == nullptr) ? &new_delete_res : _r;
+            return old;
+        }
+
+        memory_resource *get_default_resource(void) noexcept {
+            return default_res;
+        }
+
+        // 未给出初始大小时第一次向上游申请的大小
+        static constexpr size_t MONOTONIC_INIT_SIZE = 1024;
+
+        monotonic_buffer_resource::monotonic_buffer_resource(
+            memory_resource *_upstream)
+            : upstream(_upstream), initial_buffer(nullptr), initial_size(0),
+              cur(nullptr), left(0), next_size(MONOTONIC_INIT_SIZE),
+              chunks(nullptr) {
+            return;
+        }
+
+        monotonic_buffer_resource::monotonic_buffer_resource(
+            size_t _initial_size, memory_resource *_upstream)
+            : upstream(_upstream), initial_buffer(nullptr), initial_size(0),
+              cur(nullptr), left(0),
+              next_size(_initial_size == 0 ? 1 : _initial_size),
+              chunks(nullptr) {
+            return;
+        }
+
+        monotonic_buffer_resource::monotonic_buffer_resource(
+            void *_buffer, size_t _buffer_size, memory_resource *_upstream)
+            : upstream(_upstream), initial_buffer(_buffer),
+              initial_size(_buffer_size), cur((uint8_t *)_buffer),
+              left(_buffer_size),
+              next_size(_buffer_size == 0 ? MONOTONIC_INIT_SIZE
+                                          : _buffer_size * 2),
+              chunks(nullptr) {
+            return;
+        }
+
+        monotonic_buffer_resource::~monotonic_buffer_resource(void) {
+            release();
+            return;
+        }
+
+        void monotonic_buffer_resource::release(void) {
+            while (chunks != nullptr) {
+                chunk_t *next = chunks->next;
+                upstream->deallocate(chunks, chunks->size);
+                chunks = next;
+            }
+            cur  = (uint8_t *)initial_buffer;
+            left = initial_size;
+            return;
+        }
+
+        void *monotonic_buffer_resource::do_allocate(size_t _bytes,
+                                                     size_t _align) {
+            uintptr_t p   = align_up((uintptr_t)cur, _align);
+            size_t    pad = p - (uintptr_t)cur;
+            if (cur == nullptr || pad + _bytes > left) {
+                // 当前缓冲区不足，按几何级数向上游申请新块
+                size_t need = sizeof(chunk_t) + _align + _bytes;
+                while (next_size < need) {
+                    next_size *= 2;
+                }
+                chunk_t *c = (chunk_t *)upstream->allocate(next_size);
+                if (c == nullptr) {
+                    return nullptr;
+                }
+                c->next   = chunks;
+                c->size   = next_size;
+                chunks    = c;
+                cur       = (uint8_t *)(c + 1);
+                left      = next_size - sizeof(chunk_t);
+                next_size = next_size * 2;
+                p         = align_up((uintptr_t)cur, _align);
+                pad       = p - (uintptr_t)cur;
+            }
+            cur += pad + _bytes;
+            left -= pad + _bytes;
+            return (void *)p;
+        }
+
+        void monotonic_buffer_resource::do_deallocate(void *, size_t,
+                                                      size_t) {
+            return;
+        }
+
+        bool monotonic_buffer_resource::do_is_equal(
+            const memory_resource &_other) const noexcept {
+            return this == &_other;
+        }
+
+        // 池资源缺省参数
+        static constexpr size_t POOL_MAX_BLOCKS_PER_CHUNK = 128;
+        static constexpr size_t POOL_INIT_BLOCKS          = 8;
+
+        unsynchronized_pool_resource::unsynchronized_pool_resource(
+            const pool_options &_opts, memory_resource *_upstream)
+            : upstream(_upstream), opts(_opts), chunks(nullptr) {
+            size_t largest = MIN_BLOCK << (POOL_COUNT - 1);
+            if (opts.largest_required_pool_block == 0 ||
+                opts.largest_required_pool_block > largest) {
+                opts.largest_required_pool_block = largest;
+            }
+            if (opts.max_blocks_per_chunk == 0) {
+                opts.max_blocks_per_chunk = POOL_MAX_BLOCKS_PER_CHUNK;
+            }
+            for (size_t i = 0; i < POOL_COUNT; i++) {
+                free_list[i]   = nullptr;
+                next_blocks[i] = POOL_INIT_BLOCKS;
+            }
+            return;
+        }
+
+        unsynchronized_pool_resource::~unsynchronized_pool_resource(void) {
+            release();
+            return;
+        }
+
+        void unsynchronized_pool_resource::release(void) {
+            while (chunks != nullptr) {
+                chunk_t *next = chunks->next;
+                upstream->deallocate(chunks, chunks->size);
+                chunks = next;
+            }
+            for (size_t i = 0; i < POOL_COUNT; i++) {
+                free_list[i]   = nullptr;
+                next_blocks[i] = POOL_INIT_BLOCKS;
+            }
+            return;
+        }
+
+        size_t unsynchronized_pool_resource::pool_index(size_t _bytes,
+                                                        size_t _align) const {
+            size_t size = _bytes > _align ? _bytes : _align;
+            if (size > opts.largest_required_pool_block) {
+                return POOL_COUNT;
+            }
+            size_t idx = 0;
+            while ((MIN_BLOCK << idx) < size) {
+                idx++;
+            }
+            return idx;
+        }
+
+        bool unsynchronized_pool_resource::refill(size_t _idx) {
+            size_t block = MIN_BLOCK << _idx;
+            // 上游不一定满足 block 对齐，多申请 block - 1 字节自行对齐
+            // 对象大小为 2 的幂，首个对象对齐后其余对象也对齐
+            size_t overhead = sizeof(chunk_t) + block - 1;
+            // 块的大小不能超过 MAX_CHUNK，否则上游无法满足
+            size_t limit = (MAX_CHUNK - overhead) / block;
+            if (limit > opts.max_blocks_per_chunk) {
+                limit = opts.max_blocks_per_chunk;
+            }
+            size_t count = next_blocks[_idx];
+            if (count > limit) {
+                count = limit;
+            }
+            size_t   size = overhead + block * count;
+            chunk_t *c    = (chunk_t *)upstream->allocate(size);
+            if (c == nullptr) {
+                return false;
+            }
+            c->next    = chunks;
+            c->size    = size;
+            chunks     = c;
+            uint8_t *p = (uint8_t *)align_up((uintptr_t)(c + 1), block);
+            for (size_t i = count; i > 0; i--) {
+                free_t *f       = (free_t *)(p + (i - 1) * block);
+                f->next         = free_list[_idx];
+                free_list[_idx] = f;
+            }
+            // 下次申请的对象数翻倍，直到上限
+            next_blocks[_idx] = count * 2 < limit ? count * 2 : limit;
+            return true;
+        }
+
+        void *unsynchronized_pool_resource::do_allocate(size_t _bytes,
+                                                        size_t _align) {
+            size_t idx = pool_index(_bytes, _align);
+            if (idx == POOL_COUNT) {
+                return upstream->allocate(_bytes, _align);
+            }
+            if (free_list[idx] == nullptr && refill(idx) == false) {
+                return nullptr;
+            }
+            free_t *f      = free_list[idx];
+            free_list[idx] = f->next;
+            return f;
+        }
+
+        void unsynchronized_pool_resource::do_deallocate(void *_p,
+                                                         size_t _bytes,
+                                                         size_t _align) {
+            size_t idx = pool_index(_bytes, _align);
+            if (idx == POOL_COUNT) {
+                upstream->deallocate(_p, _bytes, _align);
+                return;
+            }
+            free_t *f      = (free_t *)_p;
+            f->next        = free_list[idx];
+            free_list[idx] = f;
+            return;
+        }
+
+        bool unsynchronized_pool_resource::do_is_equal(
+            const memory_resource &_other) const noexcept {
+            return this == &_other;
+        }
+    };
+};
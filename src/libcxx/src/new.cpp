@@ -19,16 +19,16 @@ void operator delete(void *_p) {
     free(_p);
 }
 
-void operator delete(void *_p, size_t) {
-    free(_p);
+void operator delete(void *_p, size_t _size) {
+    free_sized(_p, _size);
 }
 
 void operator delete[](void *_p) {
     free(_p);
 }
 
-void operator delete[](void *_p, size_t) {
-    free(_p);
+void operator delete[](void *_p, size_t _size) {
+    free_sized(_p, _size);
 }
 
 void *operator new(size_t, void *_p) throw() {
@@ -66,11 +66,11 @@ void operator delete[](void *_p, std::align_val_t) {
     return;
 }
 
-void operator delete(void *_p, size_t, std::align_val_t) {
-    free(_p);
+void operator delete(void *_p, size_t _size, std::align_val_t) {
+    free_sized(_p, _size);
     return;
 }
-void operator delete[](void *_p, size_t, std::align_val_t) {
-    free(_p);
+void operator delete[](void *_p, size_t _size, std::align_val_t) {
+    free_sized(_p, _size);
     return;
 }